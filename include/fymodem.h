@@ -40,6 +40,19 @@ int32_t fymodem_send(int fd,
                      size_t txsize,
                      const char *filename);
 
+/* crc16-xmodem used in each packet, pass the previous crc (initially 0) to continue over multiple buffers */
+uint16_t fymodem_crc16(uint16_t crc, const uint8_t *buf, size_t len);
+
+/* copies the next len bytes of a file into buf, returns the number of bytes copied */
+typedef size_t (*fymodem_read_fn)(void *ctx, uint8_t *buf, size_t len);
+
+/* send file over ymodem, reading each packet from read as it is sent */
+int32_t fymodem_send_stream(int fd,
+                            fymodem_read_fn read,
+                            void *ctx,
+                            size_t txsize,
+                            const char *filename);
+
 #ifdef __cplusplus
 }
 #endif
@@ -19,7 +19,9 @@
 
 #include <string>
 #include <vector>
+#include <span>
 #include <cstdint>
+#include <functional>
 
 namespace radio_tool::device
 {
@@ -30,7 +32,13 @@ namespace radio_tool::device
 
 		auto SetAddress(const uint32_t&) const -> void;
 		auto Erase(const uint32_t& amount) const -> void;
-		auto Write(const std::vector<uint8_t>& data) const -> void;
+		auto Write(std::span<const uint8_t> data) const -> void;
+
+		/**
+		 * Send size bytes, reading each packet from read as it is sent
+		 * @param read Copies the next bytes into its argument, returns how many were copied
+		 */
+		auto Write(const size_t& size, const std::function<size_t(std::span<uint8_t>)>& read) const -> void;
 		auto Read(const uint16_t& size) const->std::vector<uint8_t>;
 		auto Status() const -> const std::string;
 
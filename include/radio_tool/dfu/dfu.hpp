@@ -22,9 +22,14 @@
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <initializer_list>
 #include <iostream>
+#include <optional>
+#include <span>
 
 #include <libusb-1.0/libusb.h>
+#include <radio_tool/dfu/dfu_poll_scheduler.hpp>
 
 namespace radio_tool::dfu
 {
@@ -193,6 +198,10 @@ namespace radio_tool::dfu
         }
 
         const DFUStatus status;
+
+        /**
+         * bwPollTimeout, minimum time in ms to wait before the next GETSTATUS
+         */
         const uint32_t timeout;
         const DFUState state;
         const uint8_t discarded;
@@ -201,7 +210,7 @@ namespace radio_tool::dfu
         {
             return DFUStatusReport(
                 static_cast<DFUStatus>((int)data[0]),
-                (((data[1] << 8) | data[2]) << 8) | data[3],
+                data[1] | (data[2] << 8) | (data[3] << 16), //bwPollTimeout is 24-bit little-endian
                 static_cast<DFUState>((int)data[4]),
                 (int)data[5]);
         }
@@ -228,25 +237,235 @@ namespace radio_tool::dfu
         }
     };
 
+    /**
+     * DFU functional descriptor (DFU 1.1, 4.1.3)
+     */
+    class DFUFunctionalDescriptor
+    {
+    public:
+        static constexpr auto DescriptorType = 0x21;
+        static constexpr auto DescriptorSize = 9;
+
+        DFUFunctionalDescriptor(const uint8_t &attributes, const uint16_t &detach_timeout, const uint16_t &transfer_size, const uint16_t &version)
+            : attributes(attributes), detach_timeout(detach_timeout), transfer_size(transfer_size), version(version)
+        {
+        }
+
+        /**
+         * bmAttributes
+         */
+        const uint8_t attributes;
+
+        /**
+         * wDetachTimeOut, ms to wait for a USB reset after DFU_DETACH
+         */
+        const uint16_t detach_timeout;
+
+        /**
+         * wTransferSize, max bytes per DNLOAD/UPLOAD request
+         */
+        const uint16_t transfer_size;
+
+        /**
+         * bcdDFUVersion (0x011a for DfuSe)
+         */
+        const uint16_t version;
+
+        auto CanDownload() const -> bool
+        {
+            return (attributes & 0x01) != 0;
+        }
+
+        auto CanUpload() const -> bool
+        {
+            return (attributes & 0x02) != 0;
+        }
+
+        auto ManifestationTolerant() const -> bool
+        {
+            return (attributes & 0x04) != 0;
+        }
+
+        auto WillDetach() const -> bool
+        {
+            return (attributes & 0x08) != 0;
+        }
+
+        static auto Parse(const uint8_t data[9]) -> const DFUFunctionalDescriptor
+        {
+            return DFUFunctionalDescriptor(
+                data[2],
+                data[3] | (data[4] << 8),
+                data[5] | (data[6] << 8),
+                data[7] | (data[8] << 8));
+        }
+
+        auto ToString() const -> std::string
+        {
+            std::stringstream out;
+            out << "Attributes: 0x" << std::setfill('0') << std::setw(2) << std::hex << (int)attributes << ", "
+                << "DetachTimeout: " << std::dec << detach_timeout << "ms, "
+                << "TransferSize: " << transfer_size << ", "
+                << "Version: 0x" << std::setfill('0') << std::setw(4) << std::hex << version;
+            return out.str();
+        }
+    };
+
+    /**
+     * Host side copy of the device DFU state
+     *
+     * Tracks the state transitions reported by GETSTATUS/GETSTATE and the
+     * requests we send, so the device only needs to be asked when the state
+     * is unknown (new session, or after an error)
+     */
+    class DFUSession
+    {
+    public:
+        /**
+         * Record the state from a status report
+         */
+        auto Update(const DFUStatusReport &report) -> void
+        {
+            if (report.status != DFUStatus::OK)
+            {
+                Invalidate();
+            }
+            else
+            {
+                state = report.state;
+            }
+        }
+
+        /**
+         * Record a state which is known to be current
+         */
+        auto Update(const DFUState &s) -> void
+        {
+            state = s;
+        }
+
+        /**
+         * Forget the tracked state, the next operation will query the device
+         */
+        auto Invalidate() -> void
+        {
+            state.reset();
+        }
+
+        /**
+         * The tracked state, empty if unknown
+         */
+        auto State() const -> const std::optional<DFUState> &
+        {
+            return state;
+        }
+
+        /**
+         * If the tracked state is known and is one of the states given
+         */
+        auto IsIn(std::initializer_list<DFUState> states) const -> bool
+        {
+            return state.has_value() && std::find(states.begin(), states.end(), state.value()) != states.end();
+        }
+
+    private:
+        std::optional<DFUState> state;
+    };
+
     class DFU
     {
     public:
-        DFU(libusb_device_handle *device)
-            : timeout(5000), device(device) {}
+        DFU(libusb_device_handle *device, libusb_context *ctx = nullptr)
+            : usb_ctx(ctx), timeout(5000), device(device), functional(ReadFunctionalDescriptor(device)) {}
+
+        /**
+         * Transfer size used when none is advertised by the device
+         */
+        static constexpr uint16_t DefaultTransferSize = 1024;
 
         auto SetAddress(const uint32_t &) const -> void;
-        auto Erase(const uint32_t &) const -> void;
-        auto Download(const std::vector<uint8_t> &, const uint16_t &wValue = 0) const -> void;
-        auto Upload(const uint16_t &, const uint8_t &wValue = 0) const -> std::vector<uint8_t>;
+        /**
+         * Erase the sector at an address
+         * @param size Sector size, used to learn erase timings
+         */
+        auto Erase(const uint32_t &, const uint32_t &size = 0) const -> void;
+
+        /**
+         * Erase the whole flash (DfuSe erase command with no address)
+         * @param size Flash size, used to learn erase timings
+         */
+        auto MassErase(const uint32_t &size = 0) const -> void;
+        auto Download(std::span<const uint8_t>, const uint16_t &wValue = 0) const -> void;
+
+        /**
+         * Download a short command without building a vector
+         */
+        auto Download(std::initializer_list<uint8_t> data, const uint16_t &wValue = 0) const -> void
+        {
+            Download(std::span<const uint8_t>(data.begin(), data.size()), wValue);
+        }
+
+        /**
+         * Download a contiguous buffer as consecutive blocks of transfer_size, starting at block wValue
+         * @note Uses the pipelined async engine when the libusb context is known
+         */
+        auto DownloadBlocks(const uint8_t *data, const size_t &len, const uint16_t &transfer_size, const uint16_t &wValue) const -> void;
+        auto Upload(const uint16_t &, const uint16_t &wValue = 0) const -> std::vector<uint8_t>;
+
+        /**
+         * Upload len bytes as consecutive blocks of transfer_size, starting at block wValue
+         * @note Throws if the device ends the upload early
+         */
+        auto UploadBlocks(uint8_t *data, const size_t &len, const uint16_t &transfer_size, const uint16_t &wValue) const -> void;
 
         auto Get() const -> std::vector<uint8_t>;
         auto ReadUnprotected() const -> void;
 
         auto GetState() const -> DFUState;
         auto GetStatus() const -> const DFUStatusReport;
+        /**
+         * Return to dfuIDLE, only valid from the idle and sync states
+         */
         auto Abort() const -> void;
+
+        /**
+         * Clear the error status, the way out of dfuERROR
+         */
+        auto ClearStatus() const -> void;
         auto Detach() const -> void;
 
+        /**
+         * Get the host side state tracking for this device
+         */
+        auto GetSession() const -> const DFUSession &
+        {
+            return session;
+        }
+
+        /**
+         * Get the status polling scheduler, set the model on it to learn timings per radio
+         */
+        auto GetPollScheduler() const -> DFUPollScheduler &
+        {
+            return poll;
+        }
+
+        /**
+         * Get the DFU functional descriptor, empty if the device didnt provide one
+         */
+        auto GetFunctionalDescriptor() const -> const std::optional<DFUFunctionalDescriptor> &
+        {
+            return functional;
+        }
+
+        /**
+         * Largest block size the device accepts for DNLOAD/UPLOAD (wTransferSize)
+         */
+        auto TransferSize() const -> uint16_t
+        {
+            return functional.has_value() && functional->transfer_size > 0 ? functional->transfer_size : DefaultTransferSize;
+        }
+
     private:
         libusb_context *usb_ctx;
         auto GetDeviceString(const libusb_device_descriptor &, libusb_device_handle *) const -> std::wstring;
@@ -255,15 +474,47 @@ namespace radio_tool::dfu
         const uint16_t timeout;
         libusb_device_handle *device;
 
+        /**
+         * Functional descriptor read when the device was opened
+         */
+        const std::optional<DFUFunctionalDescriptor> functional;
+
+        /**
+         * Tracked device state, updated by every request
+         */
+        mutable DFUSession session;
+
+        /**
+         * Decides when to poll status while the device is busy
+         */
+        mutable DFUPollScheduler poll;
+
         auto CheckDevice() const -> void;
 
+        /**
+         * Find the DFU functional descriptor in the active configuration
+         */
+        static auto ReadFunctionalDescriptor(libusb_device_handle *device) -> std::optional<DFUFunctionalDescriptor>;
+
+        /**
+         * Send a DNLOAD and wait for the device to finish executing it
+         */
+        auto Execute(std::span<const uint8_t>, const uint16_t &wValue, const DFUOperation &op, const uint32_t &size) const -> void;
+
+        /**
+         * Poll status until the device leaves DFU_DOWNLOAD_BUSY
+         */
+        auto WaitForIdle(const DFUStatusReport &busy, const DFUOperation &op, const uint32_t &size) const -> void;
+
         /**
          * Ensures the state is DFU_IDLE or DFU_DNLOAD_IDLE
+         * @note The device is only queried when the tracked state is unknown
          */
         auto InitDownload() const -> void;
 
         /**
          * Ensures the state is DFU_IDLE or DFU_DPLOAD_IDLE
+         * @note The device is only queried when the tracked state is unknown
          */
         auto InitUpload() const -> void;
     };
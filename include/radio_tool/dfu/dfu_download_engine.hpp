@@ -0,0 +1,102 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <radio_tool/dfu/dfu.hpp>
+
+#include <stdint.h>
+#include <vector>
+#include <string>
+#include <chrono>
+
+#include <libusb-1.0/libusb.h>
+
+namespace radio_tool::dfu
+{
+    /**
+     * Pipelined DFU download built on libusb async transfers
+     *
+     * Each block still goes DNLOAD -> GETSTATUS (busy) -> GETSTATUS (idle), but the
+     * chain is driven from the transfer callbacks, so the next DNLOAD is submitted
+     * from the event thread as soon as the device reports DFU_DOWNLOAD_IDLE.
+     * The next block (setup packet + payload) is prepared while the device is busy.
+     *
+     * Status polls while busy are timed by a DFUPollScheduler, the wait happens on the
+     * calling thread so the event thread is never blocked.
+     */
+    class DFUDownloadEngine
+    {
+    public:
+        DFUDownloadEngine(libusb_context *ctx, libusb_device_handle *device, const uint16_t &timeout, const DFUPollScheduler &poll);
+        ~DFUDownloadEngine();
+
+        DFUDownloadEngine(const DFUDownloadEngine &) = delete;
+        auto operator=(const DFUDownloadEngine &) -> DFUDownloadEngine & = delete;
+
+        /**
+         * Download a contiguous buffer in blocks of transfer_size, numbering blocks from wValue
+         * @note The device must be in DFU_IDLE or DFU_DOWNLOAD_IDLE with the address already set
+         */
+        auto Download(const uint8_t *data, const size_t &len, const uint16_t &transfer_size, const uint16_t &wValue) -> void;
+
+    private:
+        enum class Stage
+        {
+            Download,
+            StatusBusy,
+            StatusIdle
+        };
+
+        static constexpr auto StatusSize = 6;
+
+        libusb_context *ctx;
+        libusb_device_handle *device;
+        const uint16_t timeout;
+        const DFUPollScheduler &poll;
+
+        libusb_transfer *dnload[2];
+        libusb_transfer *status;
+        std::vector<uint8_t> dnload_buffer[2];
+        uint8_t status_buffer[LIBUSB_CONTROL_SETUP_SIZE + StatusSize];
+
+        const uint8_t *data;
+        size_t len, block, blocks;
+        uint16_t transfer_size, first_block;
+        uint8_t active;
+        Stage stage;
+
+        /**
+         * Busy tracking for the current block
+         */
+        std::chrono::steady_clock::time_point busy_since, poll_at;
+        uint32_t attempt;
+        bool poll_pending, prepared;
+
+        int completed;
+        std::string error;
+
+        static void LIBUSB_CALL OnTransfer(libusb_transfer *tx);
+
+        auto HandleTransfer(libusb_transfer *tx) -> void;
+        auto SchedulePoll(const DFUStatusReport &report) -> void;
+        auto WaitEvents() -> void;
+        auto Prepare(const uint8_t &slot, const size_t &blk) -> void;
+        auto Submit(libusb_transfer *tx) -> void;
+        auto Finish(const std::string &err = std::string()) -> void;
+    };
+} // namespace radio_tool::dfu
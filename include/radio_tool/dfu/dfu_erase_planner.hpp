@@ -0,0 +1,139 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <radio_tool/dfu/dfu.hpp>
+#include <radio_tool/util/flash.hpp>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <chrono>
+
+namespace radio_tool::dfu
+{
+    enum class EraseStrategy : uint8_t
+    {
+        /**
+         * Nothing to erase
+         */
+        None,
+        /**
+         * One DfuSe erase per sector
+         */
+        Sectors,
+        /**
+         * One DfuSe mass erase (0x41 with no address)
+         */
+        Mass
+    };
+
+    static auto ToString(EraseStrategy s)
+    {
+        switch (s)
+        {
+        case EraseStrategy::None:
+            return "None";
+        case EraseStrategy::Sectors:
+            return "Sectors";
+        case EraseStrategy::Mass:
+            return "Mass";
+        }
+        return "**UKNOWN**";
+    };
+
+    class ErasePlan
+    {
+    public:
+        EraseStrategy strategy;
+
+        /**
+         * Sectors written by the firmware, these are erased one by one for EraseStrategy::Sectors
+         */
+        std::vector<flash::FlashSector> sectors;
+
+        /**
+         * Estimated time for the chosen strategy
+         */
+        std::chrono::microseconds estimate;
+
+        /**
+         * Estimated time of erasing each sector, for comparison
+         */
+        std::chrono::microseconds sectors_estimate;
+
+        auto ToString() const -> std::string;
+    };
+
+    /**
+     * Chooses between erasing each sector a firmware writes and one mass erase
+     *
+     * Costs come from the busy times learned in DFUTimingTable for the radio model,
+     * falling back to STM32F4 datasheet erase times. A mass erase is only considered when
+     * the firmware writes every sector of the map, it is supported, and there are no
+     * protected sectors, since it erases the whole flash.
+     */
+    class DFUErasePlanner
+    {
+    public:
+        /**
+         * @param protected_sectors Sector indexes which must never be erased (e.g. a bootloader)
+         * @param mass_erase If the device supports mass erase
+         */
+        DFUErasePlanner(const flash::FlashMap &map, const std::vector<uint16_t> &protected_sectors, const bool &mass_erase)
+            : map(map), protected_sectors(protected_sectors), mass_erase(mass_erase), model("Unknown") {}
+
+        /**
+         * Radio model to look up learned erase times for
+         */
+        auto SetModel(const std::string &m) -> void
+        {
+            model = m;
+        }
+
+        /**
+         * Plan the erase for a set of <address, length> ranges
+         * @throws std::runtime_error When a range overlaps a protected sector
+         */
+        auto Plan(const std::vector<std::pair<uint32_t, uint32_t>> &ranges) const -> ErasePlan;
+
+        /**
+         * Erase the flash as planned
+         * @note EraseStrategy::Sectors erases every sector here, callers which interleave
+         * erase and write can erase plan.sectors themselves instead
+         */
+        auto Execute(const DFU &dfu, const ErasePlan &plan) const -> void;
+
+        auto EstimateSector(const flash::FlashSector &sector) const -> std::chrono::microseconds;
+        auto EstimateMass() const -> std::chrono::microseconds;
+
+        /**
+         * Size mass erase timings are recorded against
+         */
+        auto MassEraseSize() const -> uint32_t
+        {
+            return map.End() - map.Start();
+        }
+
+    private:
+        const flash::FlashMap map;
+        const std::vector<uint16_t> protected_sectors;
+        const bool mass_erase;
+        std::string model;
+    };
+} // namespace radio_tool::dfu
@@ -0,0 +1,140 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <chrono>
+#include <optional>
+
+namespace radio_tool::dfu
+{
+    /**
+     * Kind of work the device does after a DNLOAD
+     */
+    enum class DFUOperation : uint8_t
+    {
+        Command,
+        Erase,
+        Program
+    };
+
+    static auto ToString(DFUOperation o)
+    {
+        switch (o)
+        {
+        case DFUOperation::Command:
+            return "Command";
+        case DFUOperation::Erase:
+            return "Erase";
+        case DFUOperation::Program:
+            return "Program";
+        }
+        return "**UKNOWN**";
+    };
+
+    /**
+     * Observed busy time for one (model, operation, size)
+     */
+    class DFUTiming
+    {
+    public:
+        /**
+         * Smoothed busy time
+         */
+        std::chrono::microseconds average;
+        std::chrono::microseconds min;
+        std::chrono::microseconds max;
+        uint32_t samples;
+    };
+
+    /**
+     * Busy times learned per radio model, shared by all devices in the process
+     */
+    class DFUTimingTable
+    {
+    public:
+        static auto Global() -> DFUTimingTable &;
+
+        auto Record(const std::string &model, const DFUOperation &op, const uint32_t &size, const std::chrono::microseconds &busy) -> void;
+        auto Get(const std::string &model, const DFUOperation &op, const uint32_t &size) const -> std::optional<DFUTiming>;
+
+        /**
+         * Print the table, one line per (model, operation, size)
+         */
+        auto ToString() const -> std::string;
+
+    private:
+        typedef std::tuple<std::string, DFUOperation, uint32_t> Key;
+
+        mutable std::mutex lock;
+        std::map<Key, DFUTiming> timings;
+    };
+
+    /**
+     * Give up if a single command or block keeps the device busy this long
+     */
+    constexpr auto MaxBusy = std::chrono::seconds(60);
+
+    /**
+     * Decides when to send the next GETSTATUS while the device is busy
+     *
+     * Waits at least bwPollTimeout as the spec requires, and once a busy time has been
+     * learned for this model/operation/size, sleeps until just before it is expected to finish
+     * instead of polling. Without either, polls back off exponentially.
+     */
+    class DFUPollScheduler
+    {
+    public:
+        DFUPollScheduler()
+            : model("Unknown") {}
+
+        /**
+         * Set the radio model timings are recorded against
+         */
+        auto SetModel(const std::string &m) -> void
+        {
+            model = m;
+        }
+
+        auto GetModel() const -> const std::string &
+        {
+            return model;
+        }
+
+        /**
+         * Time to wait before the next GETSTATUS
+         * @param hint bwPollTimeout from the last status report
+         * @param elapsed time since the device reported busy
+         * @param attempt number of polls already sent which still reported busy
+         */
+        auto NextPoll(const DFUOperation &op, const uint32_t &size, const std::chrono::milliseconds &hint,
+                      const std::chrono::microseconds &elapsed, const uint32_t &attempt) const -> std::chrono::microseconds;
+
+        /**
+         * Record how long an operation kept the device busy
+         */
+        auto Record(const DFUOperation &op, const uint32_t &size, const std::chrono::microseconds &busy) const -> void;
+
+    private:
+        std::string model;
+    };
+} // namespace radio_tool::dfu
@@ -52,7 +52,7 @@ namespace radio_tool::dfu
 		static const auto RegisterCommand = 0xa2;
 		static const auto RegisterSize = 1024;
 
-		TYTDFU(libusb_device_handle* h) : DFU(h) {}
+		TYTDFU(libusb_device_handle* h, libusb_context* ctx = nullptr) : DFU(h, ctx) {}
 
 		/**
 		 * Get the radio model off the device
@@ -60,9 +60,11 @@ namespace radio_tool::fw
 			return std::make_unique<AilunceFW>();
 		}
 
+	public:
+		auto GetCipher() const -> std::shared_ptr<const cipher::Cipher> override;
+
 	private:
 		std::string radio_model;
-		auto ApplyXOR() -> void;
 
 	};
 } // namespace radio_tool::fw
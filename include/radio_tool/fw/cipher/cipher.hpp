@@ -0,0 +1,166 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <span>
+#include <cstdint>
+
+namespace radio_tool::fw
+{
+    /**
+     * Direction of a cipher transform
+     */
+    enum class CipherDirection : uint8_t
+    {
+        Decrypt,
+        Encrypt
+    };
+} // namespace radio_tool::fw
+
+namespace radio_tool::fw::cipher
+{
+    /**
+     * A firmware cipher which can transform any chunk of a binary on its own
+     *
+     * Ciphers hold no state between calls, one instance can be used from many threads
+     * and chunks can be transformed in any order
+     */
+    class Cipher
+    {
+    public:
+        virtual ~Cipher() = default;
+
+        /**
+         * Transform a chunk of the binary in place
+         * @param offset Absolute offset of buf in the binary, a multiple of Alignment()
+         */
+        virtual auto Apply(const CipherDirection &dir, std::span<uint8_t> buf, const uint64_t &offset) const -> void = 0;
+
+        /**
+         * Byte sum of a chunk after the transform, without changing the chunk
+         *
+         * By default the chunk is transformed a few KiB at a time in a stack buffer,
+         * ciphers which can sum while transforming override this
+         */
+        virtual auto Sum(const CipherDirection &dir, std::span<const uint8_t> buf, const uint64_t &offset) const -> uint64_t;
+
+        /**
+         * Chunks must start on a multiple of this many bytes
+         */
+        virtual auto Alignment() const -> uint32_t
+        {
+            return 1;
+        }
+
+        auto Decrypt(std::span<uint8_t> buf, const uint64_t &offset) const -> void
+        {
+            Apply(CipherDirection::Decrypt, buf, offset);
+        }
+
+        auto Encrypt(std::span<uint8_t> buf, const uint64_t &offset) const -> void
+        {
+            Apply(CipherDirection::Encrypt, buf, offset);
+        }
+    };
+
+    /**
+     * Bytes transformed per job by ParallelApply and ParallelSum
+     */
+    constexpr uint32_t ParallelChunkSize = 0x10000;
+
+    /**
+     * Number of chunks ParallelApply splits a buffer into
+     */
+    constexpr auto ParallelChunks(const size_t &size) -> size_t
+    {
+        return (size + ParallelChunkSize - 1) / ParallelChunkSize;
+    }
+
+    /**
+     * Transform a buffer in chunks on ThreadPool::Global(), the result is the same as one Apply
+     */
+    auto ParallelApply(const Cipher &cipher, const CipherDirection &dir, std::span<uint8_t> buf, const uint64_t &offset) -> void;
+
+    /**
+     * Cipher::Sum over a buffer in chunks on ThreadPool::Global(), for checksums over transformed data
+     * this runs the cipher and the sum together in each chunk without writing the transformed bytes
+     */
+    auto ParallelSum(const Cipher &cipher, const CipherDirection &dir, std::span<const uint8_t> buf, const uint64_t &offset) -> uint64_t;
+
+    /**
+     * Repeating key XOR (TYT, Connect Systems), the same in both directions
+     */
+    class XORCipher : public Cipher
+    {
+    public:
+        XORCipher(const uint8_t *key, const uint32_t &key_len, const uint64_t &key_offset = 0)
+            : key(key), key_len(key_len), key_offset(key_offset) {}
+
+        auto Apply(const CipherDirection &dir, std::span<uint8_t> buf, const uint64_t &offset) const -> void override;
+        auto Sum(const CipherDirection &dir, std::span<const uint8_t> buf, const uint64_t &offset) const -> uint64_t override;
+
+    private:
+        const uint8_t *key;
+        const uint32_t key_len;
+
+        /**
+         * Position in the key of the first byte of the binary
+         */
+        const uint64_t key_offset;
+    };
+
+    /**
+     * Rotate, NOT and XOR (TYT SGL)
+     */
+    class SGLCipher : public Cipher
+    {
+    public:
+        SGLCipher(const uint8_t *key, const uint32_t &key_len, const uint64_t &key_offset)
+            : key(key), key_len(key_len), key_offset(key_offset) {}
+
+        auto Apply(const CipherDirection &dir, std::span<uint8_t> buf, const uint64_t &offset) const -> void override;
+
+    private:
+        const uint8_t *key;
+        const uint32_t key_len;
+        const uint64_t key_offset;
+    };
+
+    /**
+     * Per word masks (Ailunce), the same in both directions
+     *
+     * Whole words are transformed up to the last word of the binary and the
+     * trailing bytes one at a time, so the cipher needs the binary size
+     */
+    class AilunceCipher : public Cipher
+    {
+    public:
+        AilunceCipher(const uint64_t &size)
+            : size(size) {}
+
+        auto Apply(const CipherDirection &dir, std::span<uint8_t> buf, const uint64_t &offset) const -> void override;
+
+        auto Alignment() const -> uint32_t override
+        {
+            return sizeof(uint32_t);
+        }
+
+    private:
+        const uint64_t size;
+    };
+} // namespace radio_tool::fw::cipher
@@ -70,12 +70,17 @@ namespace radio_tool::fw
         {
             return std::make_unique<CSFW>();
         }
+    public:
+        auto GetCipher() const -> std::shared_ptr<const cipher::Cipher> override;
+
     private:
         CS800D_header header;
         uint16_t checksum;
 
+        /**
+         * Checksum of the header and XORed image, without copying the image
+         */
         auto MakeChecksum() const -> uint16_t;
-        auto MakeFiledata() const -> std::vector<uint8_t>;
         auto UpdateHeader() -> void;
     };
 } // namespace radio_tool::fw
\ No newline at end of file
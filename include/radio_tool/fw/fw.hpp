@@ -17,18 +17,113 @@
  */
 #pragma once
 
+#include <radio_tool/util/mapped_file.hpp>
+#include <radio_tool/fw/cipher/cipher.hpp>
+
 #include <string>
 #include <vector>
 #include <iterator>
 #include <cstdint>
+#include <span>
+#include <optional>
+#include <memory>
+#include <map>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
 
 namespace radio_tool::fw
 {
+	class FirmwareSupport;
+	class FirmwareStream;
+
+	/**
+	 * How the firmware binary is loaded by Read()
+	 */
+	enum class ReadMode : uint8_t
+	{
+		/**
+		 * Read the whole binary into memory
+		 */
+		Buffered,
+
+		/**
+		 * Map the file read-only, segments are decrypted on first use
+		 */
+		Mapped,
+
+		/**
+		 * Only read the headers, the binary is read from the file in chunks
+		 * as it is used, see FirmwareStream
+		 */
+		Streamed
+	};
+
+	/**
+	 * How the cipher runs over large buffers
+	 */
+	enum class ExecutionMode : uint8_t
+	{
+		Serial,
+
+		/**
+		 * Split buffers into chunks on the global thread pool
+		 */
+		Parallel
+	};
+
+	/**
+	 * Lazy view of a segments data
+	 *
+	 * size() is always free, accessing the bytes may decrypt the segment into a
+	 * private buffer the first time when the firmware is memory mapped
+	 */
+	class SegmentData
+	{
+	public:
+		SegmentData(const FirmwareSupport* owner, const uint16_t& index, const uint32_t& size)
+			: owner(owner), index(index), len(size)
+		{
+		}
+
+		auto Span() const -> std::span<const uint8_t>;
+
+		operator std::span<const uint8_t>() const
+		{
+			return Span();
+		}
+
+		auto data() const -> const uint8_t*
+		{
+			return Span().data();
+		}
+
+		auto size() const -> size_t
+		{
+			return len;
+		}
+
+		auto begin() const -> std::span<const uint8_t>::iterator
+		{
+			return Span().begin();
+		}
+
+		auto end() const -> std::span<const uint8_t>::iterator
+		{
+			return Span().end();
+		}
+
+	private:
+		const FirmwareSupport* owner;
+		uint16_t index;
+		size_t len;
+	};
+
 	class FirmwareSegment
 	{
 	public:
-		FirmwareSegment(const uint16_t& idx, const uint32_t& addr, const uint32_t& size, const std::vector<uint8_t>::const_iterator& begin, const std::vector<uint8_t>::const_iterator& end)
-			: index(idx), address(addr), size(size), data(begin, end)
+		FirmwareSegment(const uint16_t& idx, const uint32_t& addr, const uint32_t& size, const FirmwareSupport* owner)
+			: index(idx), address(addr), size(size), data(owner, idx, size)
 		{
 		}
 
@@ -48,9 +143,10 @@ namespace radio_tool::fw
 		const uint32_t size;
 
 		/**
-		 * A copy of the data from the firwmare file
+		 * View of the segment in the firmware binary
+		 * @note Only valid while the firmware handler is alive and its data is not resized
 		 */
-		const std::vector<uint8_t> data;
+		const SegmentData data;
 	};
 
 	class FirmwareSupport
@@ -98,36 +194,62 @@ namespace radio_tool::fw
 		 */
 		virtual auto IsCompatible(const FirmwareSupport* Other) const -> bool = 0;
 
+		/**
+		 * The cipher used by Decrypt()/Encrypt(), nothing if the firmware is not encrypted
+		 * @note Ciphers are stateless and can be used to transform chunks of the binary from any thread
+		 */
+		virtual auto GetCipher() const -> std::shared_ptr<const cipher::Cipher>
+		{
+			return nullptr;
+		}
+
+		auto SetExecutionMode(const ExecutionMode& mode) -> void
+		{
+			execution_mode = mode;
+		}
+
+		auto GetExecutionMode() const -> const ExecutionMode&
+		{
+			return execution_mode;
+		}
+
+		/**
+		 * Set how the next Read() loads the binary
+		 */
+		auto SetReadMode(const ReadMode& mode) -> void
+		{
+			read_mode = mode;
+		}
+
 		/**
 		 * Gets the firmware binary
+		 * @note A memory mapped binary is copied into memory first
 		 */
-		auto GetData() const -> const std::vector<uint8_t>&
+		auto GetData() -> const std::vector<uint8_t>&
 		{
+			Materialize();
 			return data;
 		}
 
 		/**
 		 * Get segments to write in the firmware
+		 * @note Segments are views into the firmware binary, computed once and cached
 		 */
-		virtual auto GetDataSegments() const -> const std::vector<FirmwareSegment>
+		virtual auto GetDataSegments() const -> const std::vector<FirmwareSegment>&
 		{
-			std::vector<FirmwareSegment> ret;
-
-			auto r_idx = 0u;
-			auto r_offset = 0u;
-			for (const auto& r : memory_ranges)
+			if (!segments || segments->size() != memory_ranges.size())
 			{
-				ret.push_back(FirmwareSegment(
-					r_idx++,
-					r.first,
-					r.second,
-					data.begin() + r_offset,
-					data.begin() + r_offset + r.second
-				));
-				r_offset += r.second;
+				segments.emplace();
+				segments->reserve(memory_ranges.size());
+
+				auto r_idx = 0u;
+				for (const auto& r : memory_ranges)
+				{
+					segments->push_back(FirmwareSegment(r_idx++, r.first, r.second, this));
+				}
 			}
 
-			return ret;
+			return segments.value();
 		}
 
 		/**
@@ -137,6 +259,8 @@ namespace radio_tool::fw
 		 */
 		virtual auto AppendSegment(const uint32_t& addr, const std::vector<uint8_t>& new_data) -> void
 		{
+			Materialize();
+
 			auto extra = align != 0 ? new_data.size() % align : 0;
 			auto new_size = new_data.size() + (extra > 0 ? align - extra : 0);
 			data.reserve(data.size() + new_size);
@@ -146,6 +270,7 @@ namespace radio_tool::fw
 				std::fill_n(std::back_inserter(data), align - extra, 0xff);
 			}
 			memory_ranges.push_back({ addr, new_size });
+			segments.reset();
 		}
 
 	protected:
@@ -153,7 +278,12 @@ namespace radio_tool::fw
 		 * Constructor with segment alignment
 		 */
 		FirmwareSupport(const uint32_t& align = 0)
-			: align(align)
+			: align(align), read_mode(ReadMode::Buffered), execution_mode(ExecutionMode::Serial)
+		{ }
+
+		FirmwareSupport(const FirmwareSupport& other)
+			: align(other.align), data(other.data), memory_ranges(other.memory_ranges), read_mode(other.read_mode), execution_mode(other.execution_mode),
+			  mapping(other.mapping), mapped(other.mapped), streamed(other.streamed), pending(other.pending)
 		{ }
 
 		/**
@@ -163,6 +293,7 @@ namespace radio_tool::fw
 
 		/**
 		 * The firmware binary
+		 * @note Empty while the binary is memory mapped or streamed, use Binary() to read or Materialize() before modifying
 		 */
 		std::vector<uint8_t> data;
 
@@ -171,5 +302,266 @@ namespace radio_tool::fw
 		 * <Address, Length>
 		 */
 		std::vector<std::pair<uint32_t, uint32_t>> memory_ranges;
+
+		/**
+		 * Apply this firmwares cipher to part of the binary
+		 * @param offset Offset of buf in the binary
+		 */
+		auto TransformSegment(const CipherDirection& dir, std::span<uint8_t> buf, const uint32_t& offset) const -> void
+		{
+			if (auto c = GetCipher())
+			{
+				if (execution_mode == ExecutionMode::Parallel && buf.size() > cipher::ParallelChunkSize)
+				{
+					cipher::ParallelApply(*c, dir, buf, offset);
+				}
+				else
+				{
+					c->Apply(dir, buf, offset);
+				}
+			}
+		}
+
+		/**
+		 * Decrypt or encrypt the binary, deferred until segments are used when memory mapped or streamed
+		 */
+		auto Transform(const CipherDirection& dir) -> void
+		{
+			if (mapping || streamed)
+			{
+				segment_buffers.clear();
+				if (!pending)
+				{
+					pending = dir;
+					return;
+				}
+				if (pending.value() != dir)
+				{
+					//encrypt after decrypt (or the other way) is the original file
+					pending.reset();
+					return;
+				}
+				Materialize();
+			}
+			TransformSegment(dir, data, 0);
+		}
+
+		/**
+		 * Load the binary from a file, reading or mapping it depending on the read mode
+		 */
+		auto LoadPayload(const std::string& file, const uint64_t& offset, const uint64_t& size) -> void
+		{
+			segments.reset();
+			segment_buffers.clear();
+			pending.reset();
+			streamed.reset();
+			if (read_mode == ReadMode::Streamed)
+			{
+				std::ifstream i(file, std::ios_base::binary | std::ios_base::ate);
+				if (!i.is_open())
+				{
+					throw std::runtime_error("Can't open firmware file");
+				}
+				if (offset + size > static_cast<uint64_t>(i.tellg()))
+				{
+					throw std::runtime_error("Firmware file is too short");
+				}
+				data.clear();
+				mapping.reset();
+				mapped = {};
+				streamed = StreamedPayload{ file, offset, size };
+				return;
+			}
+			if (read_mode == ReadMode::Mapped)
+			{
+				auto map = std::make_shared<const MappedFile>(file);
+				if (offset + size > map->Size())
+				{
+					throw std::runtime_error("Firmware file is too short");
+				}
+				data.clear();
+				mapping = map;
+				mapped = map->Data().subspan(offset, size);
+				return;
+			}
+
+			mapping.reset();
+			mapped = {};
+			std::ifstream i(file, std::ios_base::binary);
+			if (!i.is_open())
+			{
+				throw std::runtime_error("Can't open firmware file");
+			}
+			i.seekg(offset);
+			data.resize(size);
+			i.read((char*)data.data(), data.size());
+		}
+
+		/**
+		 * The current binary, without any deferred transform applied
+		 * @note Empty when streamed, use PayloadSize() for the size
+		 */
+		auto Binary() const -> std::span<const uint8_t>
+		{
+			return mapping ? mapped : std::span<const uint8_t>(data);
+		}
+
+		/**
+		 * Size of the binary, without reading it
+		 */
+		auto PayloadSize() const -> uint64_t
+		{
+			return streamed ? streamed->size : Binary().size();
+		}
+
+		auto GetReadMode() const -> const ReadMode&
+		{
+			return read_mode;
+		}
+
+		/**
+		 * Copy a memory mapped or streamed binary into data, applying any deferred transform
+		 */
+		auto Materialize() -> void
+		{
+			if (!mapping && !streamed)
+			{
+				return;
+			}
+
+			if (streamed)
+			{
+				std::ifstream in;
+				data.resize(streamed->size);
+				ReadPayload(in, 0, data);
+			}
+			else
+			{
+				data.assign(mapped.begin(), mapped.end());
+			}
+			if (pending)
+			{
+				TransformSegment(pending.value(), data, 0);
+			}
+			pending.reset();
+			mapping.reset();
+			mapped = {};
+			streamed.reset();
+			segment_buffers.clear();
+		}
+
+	private:
+		friend class SegmentData;
+		friend class FirmwareStream;
+
+		ReadMode read_mode;
+		ExecutionMode execution_mode;
+
+		/**
+		 * Memory mapped binary, shared by copies of this handler
+		 */
+		std::shared_ptr<const MappedFile> mapping;
+		std::span<const uint8_t> mapped;
+
+		/**
+		 * Where a streamed binary is in the file
+		 */
+		class StreamedPayload
+		{
+		public:
+			std::string file;
+			uint64_t offset;
+			uint64_t size;
+		};
+		std::optional<StreamedPayload> streamed;
+
+		/**
+		 * Transform to apply to mapped segments when they are used
+		 */
+		std::optional<CipherDirection> pending;
+
+		/**
+		 * Cached segment views
+		 */
+		mutable std::optional<std::vector<FirmwareSegment>> segments;
+
+		/**
+		 * Segments transformed out of the mapping, by segment index
+		 */
+		mutable std::map<uint16_t, std::vector<uint8_t>> segment_buffers;
+
+		/**
+		 * Copy part of the binary into out, without any deferred transform applied
+		 * @param in Stream to read a streamed binary with, opened on first use
+		 * @remarks Bytes past the end of the binary read as 0xff (erased flash)
+		 */
+		auto ReadPayload(std::ifstream& in, const uint64_t& offset, std::span<uint8_t> out) const -> void
+		{
+			const auto size = PayloadSize();
+			const auto n = offset < size ? std::min<uint64_t>(out.size(), size - offset) : 0;
+			if (streamed)
+			{
+				if (!in.is_open())
+				{
+					in.open(streamed->file, std::ios_base::binary);
+					if (!in.is_open())
+					{
+						throw std::runtime_error("Can't open firmware file");
+					}
+				}
+				in.seekg(streamed->offset + offset);
+				if (n > 0 && !in.read((char*)out.data(), n))
+				{
+					throw std::runtime_error("Failed to read firmware file");
+				}
+			}
+			else if (n > 0)
+			{
+				auto bin = Binary().subspan(offset, n);
+				std::copy(bin.begin(), bin.end(), out.begin());
+			}
+			std::fill(out.begin() + n, out.end(), 0xff);
+		}
+
+		auto SegmentBytes(const uint16_t& index) const -> std::span<const uint8_t>
+		{
+			if (index >= memory_ranges.size())
+			{
+				throw std::out_of_range("Invalid segment index");
+			}
+
+			auto offset = 0u;
+			for (auto r = 0u; r < index; r++)
+			{
+				offset += memory_ranges[r].second;
+			}
+			if (!streamed)
+			{
+				auto view = Binary().subspan(offset, memory_ranges[index].second);
+				if (!mapping || !pending)
+				{
+					return view;
+				}
+			}
+
+			auto it = segment_buffers.find(index);
+			if (it == segment_buffers.end())
+			{
+				std::ifstream in;
+				auto buf = std::vector<uint8_t>(memory_ranges[index].second);
+				ReadPayload(in, offset, buf);
+				if (pending)
+				{
+					TransformSegment(pending.value(), buf, offset);
+				}
+				it = segment_buffers.emplace(index, std::move(buf)).first;
+			}
+			return it->second;
+		}
 	};
+
+	inline auto SegmentData::Span() const -> std::span<const uint8_t>
+	{
+		return owner->SegmentBytes(index);
+	}
 } // namespace radio_tool::fw
\ No newline at end of file
@@ -0,0 +1,131 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <radio_tool/fw/fw.hpp>
+#include <radio_tool/util/flash.hpp>
+#include <radio_tool/util/bounded_queue.hpp>
+
+#include <thread>
+
+namespace radio_tool::fw
+{
+	/**
+	 * Part of a firmware segment, ready to write to the device
+	 */
+	class FirmwareBlock
+	{
+	public:
+		/**
+		 * Index of the segment this block is from
+		 */
+		uint16_t segment;
+
+		/**
+		 * The address the block should be written to on the device
+		 */
+		uint32_t address;
+
+		/**
+		 * Offset of the block in the firmware binary
+		 */
+		uint32_t offset;
+
+		/**
+		 * Flash sector containing the block, when split using a flash map
+		 */
+		std::optional<flash::FlashSector> sector;
+
+		/**
+		 * Block data, with the firmwares deferred cipher applied
+		 */
+		std::vector<uint8_t> data;
+	};
+
+	/**
+	 * Reads a firmwares segments in blocks on a background thread
+	 *
+	 * With ReadMode::Streamed the binary is read from the file a block at a time and
+	 * Decrypt()/Encrypt() are applied to each block as it is read, so only the blocks
+	 * waiting in the queue are held in memory and the first block is ready as soon as it is read.
+	 * @note The firmware handler must not be modified while the stream is alive
+	 */
+	class FirmwareStream
+	{
+	public:
+		/**
+		 * Default block size when no flash map is used
+		 */
+		static constexpr uint32_t DefaultBlockSize = 0x10000;
+
+		/**
+		 * Default number of blocks read ahead of the consumer
+		 */
+		static constexpr size_t DefaultDepth = 4;
+
+		/**
+		 * @param map Split blocks on the sectors of this map, parts of segments outside the map are skipped.
+		 *            Without a map segments are split every block_size bytes.
+		 */
+		FirmwareStream(const FirmwareSupport& fw, const flash::FlashMap& map = {},
+			const uint32_t& block_size = DefaultBlockSize, const size_t& depth = DefaultDepth);
+		~FirmwareStream();
+
+		FirmwareStream(const FirmwareStream&) = delete;
+		auto operator=(const FirmwareStream&) -> FirmwareStream& = delete;
+
+		/**
+		 * Get the next block, waiting for it to be read
+		 * @returns nothing after the last block
+		 * @throws The error which stopped the reader
+		 */
+		auto Next() -> std::optional<FirmwareBlock>;
+
+		/**
+		 * Read the blocks as one contiguous stream of bytes
+		 * @returns bytes copied into out, less than its size only at the end
+		 */
+		auto Read(std::span<uint8_t> out) -> size_t;
+
+		/**
+		 * Apply the firmwares cipher to a copy of a blocks data
+		 */
+		auto TransformBlock(const CipherDirection& dir, std::span<uint8_t> buf, const FirmwareBlock& block) const -> void;
+
+	private:
+		const FirmwareSupport& fw;
+		const flash::FlashMap map;
+		const uint32_t block_size;
+
+		/**
+		 * Cipher for the firmwares deferred transform, shared with the reader thread
+		 */
+		const std::shared_ptr<const cipher::Cipher> cipher;
+
+		BoundedQueue<FirmwareBlock> queue;
+		std::thread reader;
+
+		/**
+		 * Block being consumed by Read()
+		 */
+		std::optional<FirmwareBlock> current;
+		size_t current_pos;
+
+		auto Produce() -> void;
+	};
+} // namespace radio_tool::fw
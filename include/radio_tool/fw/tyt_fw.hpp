@@ -209,7 +209,9 @@ namespace radio_tool::fw
 
 		static auto ReadHeader(std::ifstream&)->TYTFirmwareHeader;
 		static auto CheckHeader(const TYTFirmwareHeader&) -> void;
-		auto ApplyXOR() -> void;
+
+	public:
+		auto GetCipher() const -> std::shared_ptr<const cipher::Cipher> override;
 	};
 
 } // namespace radio_tool::fw
@@ -183,6 +183,9 @@ namespace radio_tool::fw
 			return std::make_unique<TYTSGLFW>();
 		}
 
+	public:
+		auto GetCipher() const -> std::shared_ptr<const cipher::Cipher> override;
+
 	private:
 		const TYTSGLRadioConfig* config;
 	};
@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 #include <vector>
+#include <span>
 #include <string>
 #include <sstream>
 #include <iomanip>
@@ -155,7 +156,23 @@ namespace radio_tool::h8sx
 
         auto Init() const -> void;
         auto IdentifyDevice() const -> std::string;
-        auto Download(const std::vector<uint8_t> &) const -> void;
+        auto Download(std::span<const uint8_t>) const -> void;
+
+        /**
+         * Select the device and enter the programming state
+         */
+        auto BeginDownload() const -> void;
+
+        /**
+         * Program whole 1KiB blocks of the user MAT
+         * @returns Checksum of the data, summed over all blocks for EndDownload
+         */
+        auto Program(const uint32_t &addr, std::span<const uint8_t> data) const -> uint32_t;
+
+        /**
+         * Stop programming and check the user MAT checksum
+         */
+        auto EndDownload(const uint32_t &bin_sum) const -> void;
 
     private:
         libusb_context *usb_ctx;
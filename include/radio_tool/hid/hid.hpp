@@ -18,6 +18,8 @@
 #pragma once
 
 #include <vector>
+#include <span>
+#include <initializer_list>
 #include <libusb-1.0/libusb.h>
 
 namespace radio_tool::hid
@@ -30,15 +32,32 @@ namespace radio_tool::hid
             }
 
         auto InterruptRead(const uint8_t &ep, const uint16_t &len) const -> std::vector<uint8_t>;
-        auto InterruptWrite(const uint8_t &ep, const std::vector<uint8_t>&) const -> void;
+        auto InterruptWrite(const uint8_t &ep, std::span<const uint8_t>) const -> void;
+
+        /**
+         * Write multiple views (eg. header + payload) as a single transfer
+         */
+        auto InterruptWrite(const uint8_t &ep, std::initializer_list<std::span<const uint8_t>>) const -> void;
 
         auto BulkRead(const uint8_t &ep, const uint16_t &len) const -> std::vector<uint8_t>;
-        auto BulkWrite(const uint8_t &ep, const std::vector<uint8_t>&) const -> void;
+        auto BulkWrite(const uint8_t &ep, std::span<const uint8_t>) const -> void;
+        auto BulkWrite(const uint8_t &ep, std::initializer_list<std::span<const uint8_t>>) const -> void;
+
+        /**
+         * Largest transfer which can be gathered from multiple views
+         */
+        static constexpr auto MaxGatherSize = 1024u;
+
     protected:
         const uint16_t timeout;
         libusb_device_handle *device;
 
 
         auto HandleEvents() const -> void;
+
+        /**
+         * Copy views back to back into a buffer on the stack, returns the total length
+         */
+        static auto Gather(std::span<uint8_t> out, std::initializer_list<std::span<const uint8_t>> parts) -> size_t;
     };
 };
\ No newline at end of file
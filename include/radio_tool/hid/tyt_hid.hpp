@@ -95,9 +95,15 @@ namespace radio_tool::hid
 		auto SendCommand(const std::vector<uint8_t>& cmd) -> tyt::Command;
 		auto SendCommand(const std::vector<uint8_t>& cmd, const uint8_t& size, const uint8_t& fill) -> tyt::Command;
 
+		/**
+		 * Send a command made of multiple views, without copying them into a Command first
+		 */
+		auto SendCommand(const tyt::CommandType& type, std::initializer_list<std::span<const uint8_t>> parts) -> tyt::Command;
+
 		auto SendCommandAndOk(const tyt::Command& cmd) -> void;
 		auto SendCommandAndOk(const std::vector<uint8_t>& cmd) -> void;
 		auto SendCommandAndOk(const std::vector<uint8_t>& cmd, const uint8_t& size, const uint8_t& fill) -> void;
+		auto SendCommandAndOk(const tyt::CommandType& type, std::initializer_list<std::span<const uint8_t>> parts) -> void;
 
 		auto WaitForReply()->tyt::Command;
 
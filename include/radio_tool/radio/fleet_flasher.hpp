@@ -0,0 +1,118 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2020 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <radio_tool/radio/radio_factory.hpp>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
+
+namespace radio_tool::radio
+{
+	/**
+	 * Outcome of one radio in a fleet run
+	 */
+	struct FleetResult
+	{
+		uint16_t index;
+		std::wstring device;
+		bool success;
+		std::string error;
+		std::chrono::milliseconds duration;
+
+		auto ToString() const -> const std::wstring;
+	};
+
+	/**
+	 * Work done on each opened radio, eg. WriteFirmware
+	 */
+	typedef std::function<void(RadioOperations &)> FleetJob;
+
+	/**
+	 * Runs the same job on many radios from one RadioFactory at once, USB radios share the factory's libusb context
+	 *
+	 * Each radio gets its own worker thread, the number of workers running
+	 * at once behind the same root hub port is capped so a shared hub is not saturated.
+	 * Progress output of each radio goes to std::cerr one line at a time, prefixed with its index
+	 */
+	class FleetFlasher
+	{
+	public:
+		/**
+		 * Default number of radios worked on at once behind one root port
+		 */
+		static constexpr size_t DefaultPortLimit = 4;
+
+		explicit FleetFlasher(const RadioFactory &radios, const size_t &port_limit = DefaultPortLimit);
+
+		FleetFlasher(const FleetFlasher &) = delete;
+		auto operator=(const FleetFlasher &) -> FleetFlasher & = delete;
+
+		/**
+		 * Run job on the radios at indexes in RadioFactory::ListDevices, or on every radio when indexes is empty
+		 *
+		 * Blocks until every worker has finished, failures are reported per radio
+		 * and do not stop the other workers
+		 * @throws std::runtime_error if an index is out of range
+		 */
+		auto Run(const std::vector<uint16_t> &indexes, const FleetJob &job) -> std::vector<FleetResult>;
+
+		/**
+		 * Write the firmware file to the radios at indexes, or every radio when empty
+		 */
+		auto WriteFirmware(const std::vector<uint16_t> &indexes, const std::string &file) -> std::vector<FleetResult>;
+
+	private:
+		const RadioFactory &radios;
+		size_t port_limit;
+
+		std::mutex lock;
+		std::condition_variable slot_free;
+		std::map<uint32_t, size_t> active;
+
+		/**
+		 * Holds one of the port_limit slots of a root port until destroyed
+		 */
+		class PortSlot
+		{
+		public:
+			PortSlot(FleetFlasher &fleet, const uint32_t &port);
+			~PortSlot();
+
+			PortSlot(const PortSlot &) = delete;
+			auto operator=(const PortSlot &) -> PortSlot & = delete;
+
+		private:
+			FleetFlasher &fleet;
+			const uint32_t port;
+		};
+
+		auto Work(const RadioInfo &info, const FleetJob &job) -> FleetResult;
+
+		/**
+		 * Radios sharing a key share a limit, radios which are not on USB are never grouped
+		 */
+		static auto PortKey(const RadioInfo &info) -> uint32_t;
+	};
+} // namespace radio_tool::radio
@@ -19,14 +19,22 @@
 
 #include <string>
 #include <sstream>
+#include <iostream>
 #include <iomanip>
 #include <functional>
+#include <memory>
+#include <vector>
 #include <cstdint>
 
 namespace radio_tool::radio
 {
 	class RadioOperations;
-	typedef std::function<RadioOperations *()> CreateRadioOps;
+
+	/**
+	 * Owning handle to an opened radio, releases the radio and the underlying device when destroyed
+	 */
+	typedef std::unique_ptr<RadioOperations, std::function<void(RadioOperations *)>> RadioHandle;
+	typedef std::function<RadioHandle()> CreateRadioOps;
 
 	/**
 	 * Information related to a detected radio
@@ -38,8 +46,10 @@ namespace radio_tool::radio
 		const std::wstring manufacturer;
 		const std::wstring model;
 		const std::string port;
+
+		virtual ~RadioInfo() = default;
 		virtual auto ToString() const -> const std::wstring = 0;
-		virtual auto OpenDevice() const -> RadioOperations * = 0;
+		virtual auto OpenDevice() const -> RadioHandle = 0;
 
 	protected:
 		RadioInfo(const uint16_t &index, const std::wstring &manufacturer, const std::wstring &model, const std::string &port)
@@ -68,6 +78,23 @@ namespace radio_tool::radio
 		 * Get general info about the radio
 		 */
 		virtual auto ToString() const -> const std::string = 0;
+
+		/**
+		 * Send progress output to out instead of std::cerr, out must outlive the radio
+		 */
+		auto SetLog(std::ostream &out) -> void
+		{
+			log = &out;
+		}
+
+	protected:
+		auto Log() const -> std::ostream &
+		{
+			return *log;
+		}
+
+	private:
+		std::ostream *log = &std::cerr;
 	};
 
 	/**
@@ -76,6 +103,7 @@ namespace radio_tool::radio
 	class RadioOperationsFactory
 	{
 	public:
-		virtual auto ListDevices(const uint16_t &idx_offset) const -> const std::vector<RadioInfo *> = 0;
+		virtual ~RadioOperationsFactory() = default;
+		virtual auto ListDevices(const uint16_t &idx_offset) const -> std::vector<std::unique_ptr<RadioInfo>> = 0;
 	};
 } // namespace radio_tool::radio
\ No newline at end of file
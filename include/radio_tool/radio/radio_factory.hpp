@@ -18,16 +18,44 @@
 #pragma once
 
 #include <radio_tool/radio/radio.hpp>
+#include <radio_tool/radio/usb_radio_factory.hpp>
+#include <radio_tool/radio/serial_radio_factory.hpp>
+
+#include <memory>
+#include <vector>
 
 namespace radio_tool::radio
 {
     /**
      * Primary factory for accessing and listing supported devices
+     *
+     * Devices are enumerated once when the factory is created and stay owned by it,
+     * all USB radios share the factory's libusb context
+     * @note Radios opened from this factory must be released before the factory is destroyed
      */
     class RadioFactory
     {
     public:
-        auto OpenDevice(const uint16_t& index) const -> RadioOperations*;
-        auto ListDevices() const -> const std::vector<RadioInfo*>;
+        RadioFactory();
+
+        RadioFactory(const RadioFactory&) = delete;
+        auto operator=(const RadioFactory&) -> RadioFactory& = delete;
+
+        /**
+         * Open the device at index in ListDevices
+         * @throws std::runtime_error if index is out of range
+         */
+        auto OpenDevice(const uint16_t& index) const -> RadioHandle;
+        auto ListDevices() const -> const std::vector<std::unique_ptr<RadioInfo>>&;
+
+        /**
+         * Enumerate devices again, pointers from a previous ListDevices are invalidated
+         */
+        auto Refresh() -> void;
+
+    private:
+        USBRadioFactory usb;
+        SerialRadioFactory serial;
+        std::vector<std::unique_ptr<RadioInfo>> devices;
     };
 } // namespace radio_tool::radio
\ No newline at end of file
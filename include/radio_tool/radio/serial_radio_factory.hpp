@@ -17,7 +17,6 @@
  */
 #pragma once
 
-#include <radio_tool/radio/radio_factory.hpp>
 #include <radio_tool/radio/radio.hpp>
 #include <radio_tool/util.hpp>
 
@@ -45,7 +44,7 @@ namespace radio_tool::radio
 			return os.str();
 		}
 
-		auto OpenDevice() const -> RadioOperations * override
+		auto OpenDevice() const -> RadioHandle override
 		{
 			return loader();
 		}
@@ -57,7 +56,7 @@ namespace radio_tool::radio
 	class SerialRadioFactory : public RadioOperationsFactory
 	{
 	public:
-		auto ListDevices(const uint16_t &idx_offset) const -> const std::vector<RadioInfo *> override;
+		auto ListDevices(const uint16_t &idx_offset) const -> std::vector<std::unique_ptr<RadioInfo>> override;
 
 	private:
 		auto OpDeviceList(std::function<void(const std::string &, const uint16_t &)>) const -> void;
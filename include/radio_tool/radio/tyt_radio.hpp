@@ -19,8 +19,11 @@
 
 #include <radio_tool/radio/radio.hpp>
 #include <radio_tool/dfu/tyt_dfu.hpp>
+#include <radio_tool/util/flash.hpp>
+#include <radio_tool/fw/fw_stream.hpp>
 
 #include <functional>
+#include <vector>
 #include <libusb-1.0/libusb.h>
 
 namespace radio_tool::radio
@@ -28,12 +31,25 @@ namespace radio_tool::radio
 	class TYTRadio : public RadioOperations
 	{
 	public:
-		TYTRadio(libusb_device_handle* h)
-			: dfu(h) {}
+		/**
+		 * STM32F40X sectors holding the TYT bootloader (0x08000000 - 0x0800c000)
+		 */
+		static inline const std::vector<uint16_t> BootloaderSectors = { 0, 1, 2 };
+
+		TYTRadio(libusb_device_handle* h, libusb_context* ctx = nullptr)
+			: dfu(h, ctx), differential(false) {}
 
 		auto WriteFirmware(const std::string& file) -> void override;
 		auto ToString() const -> const std::string override;
 
+		/**
+		 * Read back each sector before flashing and skip sectors which already match the firmware
+		 */
+		auto SetDifferential(const bool& diff) -> void
+		{
+			differential = diff;
+		}
+
 		static auto SupportsDevice(const libusb_device_descriptor& dev) -> bool
 		{
 			return dev.idVendor == dfu::TYTDFU::VID && dev.idProduct == dfu::TYTDFU::PID;
@@ -47,10 +63,22 @@ namespace radio_tool::radio
 			return &dfu;
 		}
 
-		static auto Create(libusb_device_handle* h) -> TYTRadio* {
-			return new TYTRadio(h);
+		/**
+		 * What a sector contains after it is erased and the plain blocks are written to it
+		 * @throws std::invalid_argument if a block is not inside the sector
+		 */
+		static auto ExpectedSector(const flash::FlashSector& sector, const std::vector<fw::FirmwareBlock>& blocks) -> std::vector<uint8_t>;
+
+		static auto Create(libusb_device_handle* h, libusb_context* ctx) -> TYTRadio* {
+			return new TYTRadio(h, ctx);
 		}
 	private:
 		const dfu::TYTDFU dfu;
+		bool differential;
+
+		/**
+		 * Check if a sector on the device already contains expected
+		 */
+		auto SectorMatches(const flash::FlashSector& sector, const std::vector<uint8_t>& expected) const -> bool;
 	};
 } // namespace radio_tool::radio
\ No newline at end of file
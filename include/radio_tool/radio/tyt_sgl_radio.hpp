@@ -21,6 +21,7 @@
 #include <radio_tool/hid/tyt_hid.hpp>
 
 #include <functional>
+#include <span>
 
 namespace radio_tool::radio
 {
@@ -41,12 +42,12 @@ namespace radio_tool::radio
 			return false;
 		}
 
-		static auto Create(libusb_device_handle* h) -> TYTSGLRadio*
+		static auto Create(libusb_device_handle* h, libusb_context*) -> TYTSGLRadio*
 		{
 			return new TYTSGLRadio(h);
 		}
 	private:
 		hid::TYTHID device;
-		auto checksum(std::vector<uint8_t>::const_iterator&& begin, std::vector<uint8_t>::const_iterator&& end) const -> uint32_t;
+		auto checksum(std::span<const uint8_t> data) const -> uint32_t;
 	};
 } // namespace radio_tool::radio
\ No newline at end of file
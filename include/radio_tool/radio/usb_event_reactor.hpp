@@ -0,0 +1,98 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#ifndef _WIN32
+#include <mutex>
+#include <vector>
+#include <poll.h>
+#endif
+
+#include <libusb-1.0/libusb.h>
+
+namespace radio_tool::radio
+{
+	/**
+	 * Completion loop for asynchronous transfers on a libusb context
+	 *
+	 * Sleeps on the context's file descriptors (epoll on Linux, poll elsewhere)
+	 * and only wakes when a transfer completes, a libusb timeout expires or Stop is called.
+	 * libusb has no pollable descriptors on Windows so the loop falls back to blocking
+	 * in libusb_handle_events and is woken by libusb_interrupt_event_handler
+	 */
+	class USBEventReactor
+	{
+	public:
+		/**
+		 * Starts the event thread, ctx must outlive the reactor
+		 */
+		explicit USBEventReactor(libusb_context *ctx);
+		~USBEventReactor();
+
+		USBEventReactor(const USBEventReactor &) = delete;
+		auto operator=(const USBEventReactor &) -> USBEventReactor & = delete;
+
+		/**
+		 * Wake the event thread and wait for it to exit, safe to call more than once
+		 */
+		auto Stop() -> void;
+
+	private:
+		libusb_context *ctx;
+		std::atomic<bool> running;
+		std::thread thread;
+
+#if defined(__linux__)
+		int epoll_fd;
+		int wake_fd;
+#elif !defined(_WIN32)
+		int wake_pipe[2];
+		std::mutex lock;
+		std::vector<pollfd> fds;
+#endif
+
+		auto Run() -> void;
+
+		/**
+		 * Block until a descriptor is ready or timeout_ms passes (-1 waits forever)
+		 */
+		auto Wait(const int &timeout_ms) -> void;
+		auto Wake() -> void;
+
+#if defined(__linux__)
+		/**
+		 * Add a libusb descriptor to the epoll set, or update its events if it is already there
+		 * @throws std::runtime_error if epoll_ctl fails
+		 */
+		auto Watch(const int &fd, const short &events) -> void;
+#endif
+
+		/**
+		 * Milliseconds until the next libusb timeout, -1 when nothing is pending
+		 */
+		auto NextTimeout() const -> int;
+
+#ifndef _WIN32
+		static void LIBUSB_CALL OnPollfdAdded(int fd, short events, void *user_data);
+		static void LIBUSB_CALL OnPollfdRemoved(int fd, void *user_data);
+#endif
+	};
+} // namespace radio_tool::radio
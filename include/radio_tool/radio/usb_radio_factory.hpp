@@ -18,31 +18,50 @@
 #pragma once
 
 #include <radio_tool/radio/radio.hpp>
+#include <radio_tool/radio/usb_event_reactor.hpp>
 
 #include <string>
 #include <vector>
 #include <memory>
 #include <functional>
-#include <thread>
 
 #include <libusb-1.0/libusb.h>
 
 namespace radio_tool::radio
 {
+	/**
+	 * Creates the radio driver for an opened device
+	 */
+	typedef std::function<RadioOperations *(libusb_device_handle *, libusb_context *)> CreateUSBRadioOps;
+
+	/**
+	 * A radio found during enumeration, keeps a reference to its libusb_device
+	 * so it can be opened again without walking the device list
+	 * @note The context the device was found on must outlive this object and any radio opened from it
+	 */
 	class USBRadioInfo : public RadioInfo
 	{
 	public:
 		const uint16_t vid, pid;
 
+		/**
+		 * Bus number, root hub port and device address of the radio
+		 */
+		const uint8_t bus, root_port, address;
+
 		USBRadioInfo(
-			const CreateRadioOps l,
+			const CreateUSBRadioOps l,
+			libusb_context *ctx,
+			libusb_device *dev,
 			const std::wstring &mfg,
 			const std::wstring &prd,
 			const uint16_t &vid,
 			const uint16_t &pid,
-			const uint16_t &idx)
-			: RadioInfo(idx, mfg, prd, ""), vid(vid), pid(pid), loader(l)
-			{}
+			const uint16_t &idx);
+		~USBRadioInfo();
+
+		USBRadioInfo(const USBRadioInfo &) = delete;
+		auto operator=(const USBRadioInfo &) -> USBRadioInfo & = delete;
 
 		auto ToString() const -> const std::wstring override
 		{
@@ -56,13 +75,15 @@ namespace radio_tool::radio
 			return os.str();
 		}
 
-		auto OpenDevice() const -> RadioOperations* override
-		{
-			return loader();
-		}
+		/**
+		 * Open the device and create its driver, the device is closed when the handle is released
+		 */
+		auto OpenDevice() const -> RadioHandle override;
 
 	private:
-		const CreateRadioOps loader;
+		const CreateUSBRadioOps loader;
+		libusb_context *ctx;
+		libusb_device *device;
 	};
 
 	/**
@@ -74,14 +95,25 @@ namespace radio_tool::radio
 	public:
 		USBRadioFactory();
 		~USBRadioFactory();
-		auto ListDevices(const uint16_t& idx_offset) const -> const std::vector<RadioInfo*> override;
-		auto HandleEvents() -> void;
+		auto ListDevices(const uint16_t& idx_offset) const -> std::vector<std::unique_ptr<RadioInfo>> override;
+
+		/**
+		 * The context owned by this factory, valid until the factory is destroyed
+		 */
+		auto GetContext() const -> libusb_context*
+		{
+			return usb_ctx;
+		}
+
+		/**
+		 * Root hub port a device is connected through, hubs in between are skipped
+		 */
+		static auto GetRootPort(libusb_device *dev) -> uint8_t;
 	private:
 		auto GetDeviceString(const uint8_t &, libusb_device_handle *) const -> std::wstring;
-		static auto OpenDevice(const uint8_t &bus, const uint8_t &port, const uint8_t& address) -> libusb_device_handle *;
 		static auto CreateContext() -> libusb_context *;
 
 		libusb_context* usb_ctx;
-		std::thread events;
+		std::unique_ptr<USBEventReactor> events;
 	};
 }
@@ -44,7 +44,7 @@ namespace radio_tool::radio
 			return dev.idVendor == VID && dev.idProduct == PID;
 		}
 
-		static auto Create(libusb_device_handle* h) -> YaesuRadio* {
+		static auto Create(libusb_device_handle* h, libusb_context*) -> YaesuRadio* {
 			return new YaesuRadio(h);
 		}
 	private:
@@ -17,6 +17,8 @@
  */
 #pragma once
 
+#include <radio_tool/util/simd.hpp>
+
 #include <vector>
 #include <stdint.h>
 #include <iostream>
@@ -25,6 +27,7 @@
 #include <algorithm>
 #include <iterator>
 #include <iomanip>
+#include <span>
 
 #if defined(_MSC_VER)
 #define bswap32(x) _byteswap_ulong((x))
@@ -134,109 +137,162 @@ namespace radio_tool
 
 	static inline auto ApplyXOR(std::vector<uint8_t>& data, const uint8_t* xor_key, const uint16_t& key_len, const uint16_t& xor_offset = 0) -> void
 	{
-		for (size_t z = 0; z < data.size(); z++)
-		{
-			data[z] = data[z] ^ xor_key[(xor_offset + z) % key_len];
-		}
+		XORKeystream(data, xor_key, key_len, xor_offset);
 	}
 
-	static inline auto ApplyXOR(std::vector<uint8_t>::iterator&& begin, std::vector<uint8_t>::iterator&& end, const uint8_t* xor_key, const uint16_t& key_len, const uint16_t& xor_offset = 0) -> void
+	/**
+	 * XOR a buffer which starts at xor_offset in the keystream
+	 */
+	static inline auto ApplyXOR(std::span<uint8_t> data, const uint8_t* xor_key, const uint32_t& key_len, const uint64_t& xor_offset) -> void
 	{
-		auto z = 0;
-		while (begin != end)
-		{
-			(*begin) = (*begin) ^ xor_key[(xor_offset + z++) % key_len];
-			std::advance(begin, 1);
-		}
+		XORKeystream(data, xor_key, key_len, xor_offset);
 	}
 
-	static auto BSDChecksum(std::vector<uint8_t>::iterator& data, const uint32_t& size) -> uint16_t
+	static inline auto ApplyXOR(std::vector<uint8_t>::iterator&& begin, std::vector<uint8_t>::iterator&& end, const uint8_t* xor_key, const uint16_t& key_len, const uint16_t& xor_offset = 0) -> void
 	{
-		int32_t checksum = 0u;
+		XORKeystream(std::span<uint8_t>(begin, end), xor_key, key_len, xor_offset);
+	}
 
-		for (size_t i = 0; i < size; i++)
+	/**
+	 * BSD sum, pass the previous checksum to continue over multiple buffers
+	 */
+	static auto BSDChecksum(std::span<const uint8_t> data, uint16_t checksum = 0) -> uint16_t
+	{
+		for (const auto& b : data)
 		{
-			checksum = (checksum >> 1) + ((checksum & 1) << 15);
-			checksum += *data;
-			checksum &= 0xffff;
-			std::advance(data, 1);
+			checksum = static_cast<uint16_t>((checksum >> 1) + ((checksum & 1) << 15) + b);
 		}
 		return checksum;
 	}
 
-	static auto Fletcher16(std::vector<uint8_t>::iterator& data, const uint32_t& size) -> uint16_t
+	/**
+	 * Fletcher-16 over data which arrives in pieces
+	 */
+	class Fletcher16Sum
 	{
-		constexpr auto block_size = 5802;
-		uint32_t c0 = 0, c1 = 0;
-		uint32_t i;
-		int32_t len = size;
+	public:
+		auto Update(std::span<const uint8_t> data) -> Fletcher16Sum&
+		{
+			Fletcher16Update(c0, c1, data);
+			length += data.size();
+			return *this;
+		}
 
-		// Found by solving for c1 overflow:
-		// n > 0 and n * (n+1) / 2 * (2^8-1) < (2^32-1).
-		for (c0 = c1 = 0; len > 0; len -= block_size)
+		/**
+		 * Append the sum of the data which follows this data, every byte of next
+		 * adds c0 to c1 once more
+		 */
+		auto Combine(const Fletcher16Sum& next) -> Fletcher16Sum&
 		{
-			uint32_t blocklen = std::min(block_size, len);
-			for (i = 0; i < blocklen; ++i)
-			{
-				c0 = c0 + (*data);
-				c1 = c1 + c0;
-				std::advance(data, 1);
-			}
-			c0 = c0 % 255;
-			c1 = c1 % 255;
+			c1 = static_cast<uint32_t>((c1 + next.c1 + (next.length % 255) * c0) % 255);
+			c0 = (c0 + next.c0) % 255;
+			length += next.length;
+			return *this;
 		}
-		//auto f0 = c0;
-		//c0 = 0xff - ((c0 + c1) % 0xff);
-		//c1 = 0xff - ((f0 + c0) % 0xff);
-		return (c1 << 8 | c0);
+
+		auto Finalize() const -> uint16_t
+		{
+			return static_cast<uint16_t>(c1 << 8 | c0);
+		}
+
+	private:
+		uint32_t c0 = 0, c1 = 0;
+		uint64_t length = 0;
+	};
+
+	static auto Fletcher16(std::span<const uint8_t> data) -> uint16_t
+	{
+		return Fletcher16Sum().Update(data).Finalize();
 	}
 
-	static auto InternetChecksum(std::vector<uint8_t>::iterator& data, const uint32_t& size) -> uint16_t
+	/**
+	 * RFC 1071 one's complement sum over data which arrives in pieces,
+	 * pieces may have odd lengths
+	 */
+	class InternetSum
 	{
-		int32_t sum = 0,
-			count = size;
+	public:
+		auto Update(std::span<const uint8_t> data) -> InternetSum&
+		{
+			if (data.empty())
+			{
+				return *this;
+			}
+			if (odd)
+			{
+				//low byte of the word started by the last piece
+				sum += data[0];
+				data = data.subspan(1);
+				odd = false;
+			}
+			sum += WordSumBE(data);
+			odd = (data.size() & 1) != 0;
+			return *this;
+		}
 
-		// Main summing loop
-		while (count > 1)
+		/**
+		 * Append the sum of the data which follows this data, when this data has an odd
+		 * length the bytes of next land in the other half of each word, which is the
+		 * same as byte swapping its folded sum (RFC 1071 2.B)
+		 */
+		auto Combine(const InternetSum& next) -> InternetSum&
 		{
-			sum = sum + (*data);
-			count = count - 2;
-			std::advance(data, 1);
+			auto next_sum = Fold(next.sum);
+			sum += odd ? static_cast<uint16_t>((next_sum << 8) | (next_sum >> 8)) : next_sum;
+			odd = odd != next.odd;
+			return *this;
 		}
 
-		// Add left-over byte, if any
-		if (count > 0)
+		/**
+		 * Folded and complemented checksum, as a big endian value
+		 */
+		auto Finalize() const -> uint16_t
 		{
-			sum = sum + (*data);
+			return static_cast<uint16_t>(~Fold(sum));
 		}
 
-		// Fold 32-bit sum to 16 bits
-		while (sum >> 16)
+	private:
+		uint64_t sum = 0;
+		bool odd = false;
+
+		static auto Fold(uint64_t s) -> uint16_t
 		{
-			sum = (sum & 0xFFFF) + (sum >> 16);
+			while (s >> 16)
+			{
+				s = (s & 0xffff) + (s >> 16);
+			}
+			return static_cast<uint16_t>(s);
 		}
+	};
 
-		return (~sum);
+	static auto InternetChecksum(std::span<const uint8_t> data) -> uint16_t
+	{
+		return InternetSum().Update(data).Finalize();
 	}
 
 	/**
-	 * Connect Systems checksum
+	 * Connect Systems checksum from the 16-bit sum of all bytes
 	 */
-	static auto CSChecksum(std::vector<uint8_t>::const_iterator&& begin, const std::vector<uint8_t>::const_iterator&& end) -> uint16_t
+	static constexpr auto CSChecksumFinalize(const uint16_t& sum) -> uint16_t
 	{
-		uint16_t sum = 0;
-
-		while (begin != end)
-		{
-			sum += (*begin);
-			std::advance(begin, 1);
-		}
-
 		auto c0 = (int32_t)(sum / 5) >> 8;
 		auto c1 = (sum / 5) & 0xff;
 		return (c1 << 8 | c0);
 	}
 
+	/**
+	 * Connect Systems checksum
+	 */
+	static auto CSChecksum(std::span<const uint8_t> data) -> uint16_t
+	{
+		return CSChecksumFinalize(static_cast<uint16_t>(ByteSum(data)));
+	}
+
+	static auto CSChecksum(std::vector<uint8_t>::const_iterator&& begin, const std::vector<uint8_t>::const_iterator&& end) -> uint16_t
+	{
+		return CSChecksum(std::span<const uint8_t>(begin, end));
+	}
+
 	static auto FormatBytes(const uint64_t& bytes, const uint8_t& precision = 2) -> std::string
 	{
 		std::stringstream ss;
@@ -0,0 +1,114 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <exception>
+#include <condition_variable>
+
+namespace radio_tool
+{
+	/**
+	 * Fixed capacity queue between a producer and a consumer thread
+	 *
+	 * Push blocks while the queue is full and Pop while it is empty, so a fast
+	 * producer can only run ahead of the consumer by the capacity
+	 */
+	template <typename T>
+	class BoundedQueue
+	{
+	public:
+		explicit BoundedQueue(const size_t& capacity)
+			: capacity(capacity), closed(false)
+		{
+		}
+
+		/**
+		 * Add an item, waiting for space
+		 * @returns false if the queue was closed, the item is dropped
+		 */
+		auto Push(T&& item) -> bool
+		{
+			std::unique_lock<std::mutex> lk(lock);
+			not_full.wait(lk, [this] { return closed || items.size() < capacity; });
+			if (closed)
+			{
+				return false;
+			}
+			items.push_back(std::move(item));
+			not_empty.notify_one();
+			return true;
+		}
+
+		/**
+		 * Take the next item, waiting for one
+		 * @returns nothing once the queue is closed and empty
+		 * @throws The error passed to Fail, after the items pushed before it
+		 */
+		auto Pop() -> std::optional<T>
+		{
+			std::unique_lock<std::mutex> lk(lock);
+			not_empty.wait(lk, [this] { return closed || !items.empty(); });
+			if (items.empty())
+			{
+				if (error)
+				{
+					std::rethrow_exception(error);
+				}
+				return {};
+			}
+			auto item = std::optional<T>(std::move(items.front()));
+			items.pop_front();
+			not_full.notify_one();
+			return item;
+		}
+
+		/**
+		 * No more items will be pushed, wakes up both sides
+		 */
+		auto Close() -> void
+		{
+			std::lock_guard<std::mutex> lk(lock);
+			closed = true;
+			not_empty.notify_all();
+			not_full.notify_all();
+		}
+
+		/**
+		 * Close the queue because the producer failed
+		 */
+		auto Fail(std::exception_ptr ex) -> void
+		{
+			std::lock_guard<std::mutex> lk(lock);
+			error = ex;
+			closed = true;
+			not_empty.notify_all();
+			not_full.notify_all();
+		}
+
+	private:
+		const size_t capacity;
+		bool closed;
+		std::exception_ptr error;
+		std::deque<T> items;
+		std::mutex lock;
+		std::condition_variable not_empty, not_full;
+	};
+} // namespace radio_tool
@@ -0,0 +1,213 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <radio_tool/util.hpp>
+
+#include <span>
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+namespace radio_tool::checksum
+{
+	/**
+	 * Checksum which is fed data in pieces, so it can be computed in the same pass that
+	 * moves or transforms the data
+	 */
+	class Checksum
+	{
+	public:
+		virtual ~Checksum() = default;
+
+		/**
+		 * Reset to the state before any data
+		 */
+		virtual auto Init() -> void = 0;
+
+		/**
+		 * Add the next piece of data
+		 */
+		virtual auto Update(std::span<const uint8_t> data) -> Checksum& = 0;
+
+		/**
+		 * Checksum of all the data so far, more data can still be added after
+		 */
+		virtual auto Finalize() const -> uint32_t = 0;
+
+		/**
+		 * Number of bits in the checksum
+		 */
+		virtual auto Width() const -> uint8_t = 0;
+
+		/**
+		 * If Combine is supported
+		 */
+		virtual auto Combinable() const -> bool
+		{
+			return false;
+		}
+
+		/**
+		 * Append a checksum of the same algorithm over the data which directly follows this data,
+		 * so pieces can be summed separately (and in parallel)
+		 * @throws std::runtime_error When the algorithm can't be combined or next is a different algorithm
+		 */
+		virtual auto Combine(const Checksum& next) -> Checksum&;
+
+		/**
+		 * New instance of the same algorithm in its initial state
+		 */
+		virtual auto Create() const -> std::unique_ptr<Checksum> = 0;
+	};
+
+	/**
+	 * Rotating 16-bit BSD sum, each step depends on the whole previous state so it can't be combined
+	 */
+	class BSD16Checksum : public Checksum
+	{
+	public:
+		auto Init() -> void override;
+		auto Update(std::span<const uint8_t> data) -> Checksum& override;
+		auto Finalize() const -> uint32_t override;
+		auto Width() const -> uint8_t override { return 16; }
+		auto Create() const -> std::unique_ptr<Checksum> override;
+
+	private:
+		uint16_t sum = 0;
+	};
+
+	class Fletcher16Checksum : public Checksum
+	{
+	public:
+		auto Init() -> void override;
+		auto Update(std::span<const uint8_t> data) -> Checksum& override;
+		auto Finalize() const -> uint32_t override;
+		auto Width() const -> uint8_t override { return 16; }
+		auto Combinable() const -> bool override { return true; }
+		auto Combine(const Checksum& next) -> Checksum& override;
+		auto Create() const -> std::unique_ptr<Checksum> override;
+
+	private:
+		Fletcher16Sum sum;
+	};
+
+	/**
+	 * RFC 1071 internet checksum
+	 */
+	class RFC1071Checksum : public Checksum
+	{
+	public:
+		auto Init() -> void override;
+		auto Update(std::span<const uint8_t> data) -> Checksum& override;
+		auto Finalize() const -> uint32_t override;
+		auto Width() const -> uint8_t override { return 16; }
+		auto Combinable() const -> bool override { return true; }
+		auto Combine(const Checksum& next) -> Checksum& override;
+		auto Create() const -> std::unique_ptr<Checksum> override;
+
+	private:
+		InternetSum sum;
+	};
+
+	/**
+	 * Checksums which are a function of the plain byte sum, combined by adding the sums
+	 */
+	class ByteSumChecksum : public Checksum
+	{
+	public:
+		auto Init() -> void override;
+		auto Update(std::span<const uint8_t> data) -> Checksum& override;
+		auto Combinable() const -> bool override { return true; }
+		auto Combine(const Checksum& next) -> Checksum& override;
+
+	protected:
+		uint64_t sum = 0;
+	};
+
+	/**
+	 * Connect Systems firmware checksum (CSFW)
+	 */
+	class ConnectSystemsChecksum : public ByteSumChecksum
+	{
+	public:
+		auto Finalize() const -> uint32_t override;
+		auto Width() const -> uint8_t override { return 16; }
+		auto Create() const -> std::unique_ptr<Checksum> override;
+	};
+
+	/**
+	 * 32-bit byte sum sent after each SGL block (TYTSGLRadio)
+	 */
+	class Sum32Checksum : public ByteSumChecksum
+	{
+	public:
+		auto Finalize() const -> uint32_t override;
+		auto Width() const -> uint8_t override { return 32; }
+		auto Create() const -> std::unique_ptr<Checksum> override;
+	};
+
+	/**
+	 * H8SX boot mode checksum, the value which makes the 8-bit sum of the data and checksum zero
+	 */
+	class H8SXChecksum : public ByteSumChecksum
+	{
+	public:
+		auto Finalize() const -> uint32_t override;
+		auto Width() const -> uint8_t override { return 8; }
+		auto Create() const -> std::unique_ptr<Checksum> override;
+	};
+
+	class ChecksumInfo
+	{
+	public:
+		ChecksumInfo(
+			const std::string& name,
+			const std::string& description,
+			std::function<std::unique_ptr<Checksum>()>&& fnCreate)
+			: Name(name), Description(description), Create(fnCreate)
+		{
+		}
+
+		const std::string Name;
+
+		const std::string Description;
+
+		const std::function<std::unique_ptr<Checksum>()> Create;
+	};
+
+	/**
+	 * All checksum algorithms, by name
+	 */
+	const std::vector<ChecksumInfo> AllChecksums = {
+		ChecksumInfo("bsd16", "BSD rotating sum", []() { return std::make_unique<BSD16Checksum>(); }),
+		ChecksumInfo("fletcher16", "Fletcher-16", []() { return std::make_unique<Fletcher16Checksum>(); }),
+		ChecksumInfo("rfc1071", "Internet checksum (RFC 1071)", []() { return std::make_unique<RFC1071Checksum>(); }),
+		ChecksumInfo("cs", "Connect Systems firmware", []() { return std::make_unique<ConnectSystemsChecksum>(); }),
+		ChecksumInfo("sum32", "32-bit byte sum (SGL flashing)", []() { return std::make_unique<Sum32Checksum>(); }),
+		ChecksumInfo("h8sx", "H8SX boot mode", []() { return std::make_unique<H8SXChecksum>(); }),
+	};
+
+	/**
+	 * Create a checksum by name
+	 * @throws std::runtime_error When there is no checksum with this name
+	 */
+	auto GetChecksum(const std::string& name) -> std::unique_ptr<Checksum>;
+} // namespace radio_tool::checksum
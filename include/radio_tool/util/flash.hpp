@@ -17,11 +17,15 @@
  */
 #pragma once
 
-#include <vector>
+#include <array>
+#include <span>
+#include <string>
+#include <sstream>
 #include <optional>
 #include <iomanip>
-#include <functional>
+#include <stdexcept>
 #include <algorithm>
+#include <initializer_list>
 
 #include <stdint.h>
 
@@ -30,7 +34,7 @@ namespace radio_tool::flash
     class FlashSector
     {
     public:
-        FlashSector(const uint16_t &idx, const uint32_t &sector_start, const uint32_t &sector_size)
+        constexpr FlashSector(const uint16_t &idx, const uint32_t &sector_start, const uint32_t &sector_size)
             : index(idx), start(sector_start), size(sector_size) {}
 
         /**
@@ -79,60 +83,171 @@ namespace radio_tool::flash
         }
     };
 
+    /**
+     * A run of equal sized sectors
+     */
+    class FlashRegion
+    {
+    public:
+        uint32_t start;
+        uint32_t sector_size;
+        uint16_t sectors;
 
-    typedef std::vector<FlashSector> FlashMap;
+        /**
+         * Index of the first sector in this run, set by FlashMap
+         */
+        uint16_t first_index = 0;
 
-    class FlashUtil
+        constexpr auto End() const -> uint32_t
+        {
+            return start + sector_size * sectors;
+        }
+    };
+
+    /**
+     * Flash geometry as runs of equal sized sectors, sectors are found with a binary
+     * search over the runs and arithmetic inside a run
+     */
+    class FlashMap
     {
     public:
         /**
-         * Get the sector of an address in a flash map
+         * Runs a map can hold, maps are stored inline so they can be constexpr
          */
-        static auto GetSector(const FlashMap &map, const uint32_t &addr) -> std::optional<const FlashSector>
+        static constexpr size_t MaxRegions = 8;
+
+        constexpr FlashMap() = default;
+
+        /**
+         * @param runs Contiguous runs in address order
+         */
+        constexpr FlashMap(std::initializer_list<FlashRegion> runs)
         {
-            for (const auto &sec : map)
+            if (runs.size() > MaxRegions)
+            {
+                throw std::invalid_argument("Too many flash regions");
+            }
+            uint16_t index = 0;
+            for (auto r : runs)
             {
-                if (sec.InSector(addr))
+                if (count > 0 && regions[count - 1].End() != r.start)
                 {
-                    return sec;
+                    throw std::invalid_argument("Flash regions must be contiguous and in order");
                 }
+                r.first_index = index;
+                index += r.sectors;
+                regions[count++] = r;
             }
-            return {};
+        }
+
+        constexpr auto Regions() const -> std::span<const FlashRegion>
+        {
+            return std::span<const FlashRegion>(regions.data(), count);
+        }
+
+        constexpr auto empty() const -> bool
+        {
+            return count == 0;
         }
 
         /**
-         * Create a simple memory layout with all sectors having the same size
+         * Number of sectors
+         */
+        constexpr auto Sectors() const -> uint32_t
+        {
+            return empty() ? 0 : regions[count - 1].first_index + regions[count - 1].sectors;
+        }
+
+        constexpr auto Start() const -> uint32_t
+        {
+            return empty() ? 0 : regions[0].start;
+        }
+
+        constexpr auto End() const -> uint32_t
+        {
+            return empty() ? 0 : regions[count - 1].End();
+        }
+
+        /**
+         * Sector by index
+         */
+        constexpr auto Sector(const uint16_t &index) const -> std::optional<FlashSector>
+        {
+            auto r = std::upper_bound(regions.begin(), regions.begin() + count, index,
+                [](const uint16_t &i, const FlashRegion &x) { return i < x.first_index; });
+            if (r == regions.begin() || index >= Sectors())
+            {
+                return {};
+            }
+            --r;
+            auto n = index - r->first_index;
+            return FlashSector(index, r->start + r->sector_size * n, r->sector_size);
+        }
+
+        /**
+         * Sector which contains addr
          */
-        static auto MakeSimpleLayout(const uint32_t& start_addr, const uint32_t& sector_size, const uint16_t& sectors) -> FlashMap
+        constexpr auto GetSector(const uint32_t &addr) const -> std::optional<FlashSector>
         {
-            auto ret = FlashMap();
-            for(auto x = 0; x < sectors; x++) 
+            auto r = std::upper_bound(regions.begin(), regions.begin() + count, addr,
+                [](const uint32_t &a, const FlashRegion &x) { return a < x.start; });
+            if (r == regions.begin() || addr >= End())
             {
-                ret.push_back(FlashSector(x, start_addr + (sector_size * x), sector_size));
+                return {};
             }
-            return ret;
+            --r;
+            auto n = (addr - r->start) / r->sector_size;
+            return FlashSector(static_cast<uint16_t>(r->first_index + n), r->start + r->sector_size * n, r->sector_size);
+        }
+
+    private:
+        std::array<FlashRegion, MaxRegions> regions = {};
+        size_t count = 0;
+    };
+
+    class FlashUtil
+    {
+    public:
+        /**
+         * Get the sector of an address in a flash map
+         */
+        static constexpr auto GetSector(const FlashMap &map, const uint32_t &addr) -> std::optional<const FlashSector>
+        {
+            return map.GetSector(addr);
+        }
+
+        /**
+         * Create a simple memory layout with all sectors having the same size
+         */
+        static constexpr auto MakeSimpleLayout(const uint32_t& start_addr, const uint32_t& sector_size, const uint16_t& sectors) -> FlashMap
+        {
+            return FlashMap{ { start_addr, sector_size, sectors } };
         }
 
         /**
          * Executes a function, sector aligned over a range of bytes for a give map
+         * 
+         * The first sector is looked up once and the rest are stepped through by index,
+         * fnOp(addr, n_bytes, sector) is called directly so it can be inlined
          */
-        static auto AlignedContiguousMemoryOp(const FlashMap& map, const uint32_t& start, const uint32_t& end,
-            const std::function<void(const uint32_t&, const uint32_t&, const FlashSector&)>& fnOp) -> void 
+        template <typename Fn>
+        static constexpr auto AlignedContiguousMemoryOp(const FlashMap& map, const uint32_t& start, const uint32_t& end, Fn&& fnOp) -> void 
         {
-            for (auto addr = start; addr < end;)
+            const auto first = map.GetSector(start);
+            if (!first)
             {
-                if(const auto& sec_info = flash::FlashUtil::GetSector(map, addr)) 
-                {
-                    auto n_bytes = std::min(end, sec_info->End()) - addr;
+                return; //unmapped region
+            }
 
-                    fnOp(addr, n_bytes, sec_info.value());
+            auto addr = start;
+            for (uint32_t index = first->index; addr < end && index < map.Sectors(); index++)
+            {
+                const auto sec_info = map.Sector(index).value();
+                auto n_bytes = std::min(end, sec_info.End()) - addr;
 
-                    addr += n_bytes;
-                } 
-                else 
-                {
-                    break; //unmapped region
-                }
+                fnOp(addr, n_bytes, sec_info);
+
+                addr += n_bytes;
             }
         }
     };
@@ -140,19 +255,10 @@ namespace radio_tool::flash
     /**
      * STM32F40X & STM32F41X Memory organization
      */
-    const FlashMap STM32F40X = {
-        {0, 0x08000000, 0x4000}, /* 16k */
-        {1, 0x08004000, 0x4000},
-        {2, 0x08008000, 0x4000},
-        {3, 0x0800c000, 0x4000},
-        {4, 0x08010000, 0x10000}, /* 64k */
-        {5, 0x08020000, 0x20000}, /* 128k */
-        {6, 0x08040000, 0x20000},
-        {7, 0x08060000, 0x20000},
-        {8, 0x08080000, 0x20000},
-        {9, 0x080a0000, 0x20000},
-        {10, 0x080c0000, 0x20000},
-        {11, 0x080e0000, 0x20000}
+    constexpr FlashMap STM32F40X = {
+        {0x08000000, 0x4000, 4}, /* 16k, sectors 0-3 */
+        {0x08010000, 0x10000, 1}, /* 64k, sector 4 */
+        {0x08020000, 0x20000, 7} /* 128k, sectors 5-11 */
     };
 
     /**
@@ -164,7 +270,7 @@ namespace radio_tool::flash
      * (16 * 4k) * 256
      * Used in: DM1701, (Others?)
      */
-    const FlashMap W25Q128JV = FlashUtil::MakeSimpleLayout(0x00, 0x10000, 0x100);
+    constexpr FlashMap W25Q128JV = FlashUtil::MakeSimpleLayout(0x00, 0x10000, 0x100);
 
     /**
      * Micron M25P16 SPI Flash (2MB)
@@ -173,6 +279,8 @@ namespace radio_tool::flash
      * 
      * 32 * 64k
      */
-    const FlashMap M25P16 = FlashUtil::MakeSimpleLayout(0x00, 0x10000, 0x20);
+    constexpr FlashMap M25P16 = FlashUtil::MakeSimpleLayout(0x00, 0x10000, 0x20);
 
+    static_assert(STM32F40X.Sectors() == 12 && STM32F40X.End() == 0x08100000);
+    static_assert(STM32F40X.GetSector(0x08010000)->index == 4 && STM32F40X.GetSector(0x080fffff)->index == 11);
 } // namespace radio_tool::flash
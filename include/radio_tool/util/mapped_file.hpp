@@ -0,0 +1,61 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <string>
+#include <span>
+#include <cstdint>
+
+namespace radio_tool
+{
+	/**
+	 * Read-only memory mapping of a whole file
+	 */
+	class MappedFile
+	{
+	public:
+		explicit MappedFile(const std::string& file);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+		/**
+		 * The mapped file contents
+		 */
+		auto Data() const -> std::span<const uint8_t>
+		{
+			return std::span<const uint8_t>(base, size);
+		}
+
+		auto Size() const -> size_t
+		{
+			return size;
+		}
+
+	private:
+		const uint8_t* base;
+		size_t size;
+#ifdef _WIN32
+		void* file_handle;
+		void* map_handle;
+#else
+		int fd;
+#endif
+	};
+} // namespace radio_tool
@@ -0,0 +1,116 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+namespace radio_tool
+{
+	/**
+	 * Instruction sets the byte kernels can use, in order of preference
+	 */
+	enum class SimdLevel : uint8_t
+	{
+		Scalar,
+		SSE2,
+		AVX2,
+		AVX512
+	};
+
+	static auto ToString(const SimdLevel& l)
+	{
+		switch (l)
+		{
+		case SimdLevel::Scalar:
+			return "Scalar";
+		case SimdLevel::SSE2:
+			return "SSE2";
+		case SimdLevel::AVX2:
+			return "AVX2";
+		case SimdLevel::AVX512:
+			return "AVX512";
+		}
+		return "**UKNOWN**";
+	}
+
+	/**
+	 * Best level supported by this CPU, detected once
+	 */
+	auto DetectSimdLevel() -> SimdLevel;
+
+	/**
+	 * Level the kernels are currently using
+	 */
+	auto GetSimdLevel() -> SimdLevel;
+
+	/**
+	 * Use a lower level than detected, mostly for testing the fallbacks
+	 * @remarks Levels above DetectSimdLevel() are clamped to it
+	 */
+	auto SetSimdLevel(const SimdLevel& level) -> void;
+
+	/**
+	 * dst[i] ^= src[i]
+	 */
+	auto XORBytes(uint8_t* dst, const uint8_t* src, const size_t& len) -> void;
+
+	/**
+	 * XOR a buffer which starts at xor_offset in a repeating keystream
+	 *
+	 * The key is walked in runs from the current key position to its end,
+	 * so there is one modulo per call instead of one per byte
+	 */
+	auto XORKeystream(std::span<uint8_t> data, const uint8_t* key, const uint32_t& key_len, const uint64_t& xor_offset) -> void;
+
+	/**
+	 * Byte sum of data XORed with the keystream, without changing data
+	 */
+	auto XORKeystreamSum(std::span<const uint8_t> data, const uint8_t* key, const uint32_t& key_len, const uint64_t& xor_offset) -> uint64_t;
+
+	/**
+	 * SGL cipher (TYTSGLFW), decrypt is ~rotl3(x) ^ key, encrypt is ~rotr3(x ^ key)
+	 * @param xor_offset Position of data[0] in the keystream
+	 */
+	auto SGLDecrypt(std::span<uint8_t> data, const uint8_t* key, const uint32_t& key_len, const uint64_t& xor_offset) -> void;
+	auto SGLEncrypt(std::span<uint8_t> data, const uint8_t* key, const uint32_t& key_len, const uint64_t& xor_offset) -> void;
+
+	/**
+	 * Ailunce word cipher (AilunceFW), each 32-bit word is XORed with 0xffffffff when it is
+	 * 0 or 0xffffffff, 0x01111111 when bit 28 is set and 0x07777777 otherwise
+	 * @param data Whole words, in host byte order
+	 */
+	auto AilunceWords(std::span<uint8_t> data) -> void;
+
+	/**
+	 * Sum of all bytes, the CS, SGL and H8SX checksums are this sum truncated
+	 */
+	auto ByteSum(std::span<const uint8_t> data) -> uint64_t;
+
+	/**
+	 * Add bytes to the running Fletcher-16 sums, c0 and c1 are left reduced mod 255
+	 */
+	auto Fletcher16Update(uint32_t& c0, uint32_t& c1, std::span<const uint8_t> data) -> void;
+
+	/**
+	 * Sum of big endian 16-bit words without folding the carries, an odd last byte
+	 * is the high byte of a zero padded word
+	 */
+	auto WordSumBE(std::span<const uint8_t> data) -> uint64_t;
+} // namespace radio_tool
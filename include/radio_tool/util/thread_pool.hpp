@@ -0,0 +1,75 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+namespace radio_tool
+{
+	/**
+	 * Fixed set of worker threads for splitting CPU bound work
+	 */
+	class ThreadPool
+	{
+	public:
+		/**
+		 * @param workers Threads to start, the thread calling ParallelFor also does work
+		 */
+		explicit ThreadPool(const size_t& workers);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+
+		/**
+		 * Pool shared by the whole process, one thread per core
+		 */
+		static auto Global() -> ThreadPool&;
+
+		/**
+		 * Number of threads which run ParallelFor work, including the caller
+		 */
+		auto Concurrency() const -> size_t
+		{
+			return workers.size() + 1;
+		}
+
+		/**
+		 * Call fn(0) .. fn(count - 1) across the pool and the calling thread
+		 *
+		 * Returns when every call has finished, and can be nested since the
+		 * caller works through the indices itself instead of waiting for a free worker
+		 * @throws The first exception thrown by fn
+		 */
+		auto ParallelFor(const size_t& count, const std::function<void(const size_t&)>& fn) -> void;
+
+	private:
+		std::vector<std::thread> workers;
+		std::deque<std::function<void()>> jobs;
+		std::mutex lock;
+		std::condition_variable wake;
+		bool stop;
+
+		auto Run() -> void;
+	};
+} // namespace radio_tool
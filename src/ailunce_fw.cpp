@@ -31,15 +31,16 @@ auto AilunceFW::Read(const std::string &file) -> void
 		i.seekg(0, std::ios_base::end);
 		auto binarySize = i.tellg();
 		memory_ranges.push_back(std::make_pair(0, binarySize));
-		i.seekg(std::ios_base::beg);
-		data.resize(binarySize);
-		i.read((char *)data.data(), data.size());
+		i.close();
+
+		LoadPayload(file, 0, binarySize);
 	}
-	i.close();
 }
 
 auto AilunceFW::Write(const std::string &file) -> void
 {
+	Materialize();
+
 	std::ofstream fout(file, std::ios_base::binary);
 	if (fout.is_open())
 	{
@@ -94,37 +95,17 @@ auto AilunceFW::SetRadioModel(const std::string &model) -> void
 
 auto AilunceFW::Decrypt() -> void
 {
-	ApplyXOR();
+	Transform(CipherDirection::Decrypt);
 }
 
 auto AilunceFW::Encrypt() -> void
 {
-	ApplyXOR();
+	Transform(CipherDirection::Encrypt);
 }
 
-auto AilunceFW::ApplyXOR() -> void
+auto AilunceFW::GetCipher() const -> std::shared_ptr<const cipher::Cipher>
 {
-	for (uint32_t i = 0; i < (data.size() / sizeof(uint32_t)); i++)
-	{
-		uint32_t *word = reinterpret_cast<uint32_t *>(data.data()) + i;
-		if (*word == 0x0 || *word == 0xffffffff)
-			*word ^= 0xffffffff;
-		else if (*word & (1 << 28))
-			*word ^= 0x01111111;
-		else
-			*word ^= 0x07777777;
-	}
-	// Last bytes
-	for (auto z = data.size() - (data.size() % sizeof(uint32_t));
-		 z < data.size(); z++)
-	{
-		if (data[z] == 0x00 || data[z] == 0xff)
-			data[z] ^= 0xff;
-		else if (data[z] & 1)
-			data[z] ^= 0x01;
-		else
-			data[z] ^= 0x07;
-	}
+	return std::make_shared<cipher::AilunceCipher>(PayloadSize());
 }
 
 auto AilunceFW::IsCompatible(const FirmwareSupport* Other) const -> bool
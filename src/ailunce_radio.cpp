@@ -18,6 +18,7 @@
  */
 #include <radio_tool/radio/ailunce_radio.hpp>
 #include <radio_tool/fw/ailunce_fw.hpp>
+#include <radio_tool/fw/fw_stream.hpp>
 
 #include <thread>
 
@@ -49,9 +50,10 @@ auto AilunceRadio::ToString() const -> const std::string
 auto AilunceRadio::WriteFirmware(const std::string &file) -> void
 {
     auto fw = fw::AilunceFW();
+    fw.SetReadMode(fw::ReadMode::Streamed);
     fw.Read(file);
 
-    //XOR raw binary data before sending
+    //XOR raw binary data before sending, applied to each block as it is read
     fw.Encrypt();
     
     device.SetInterfaceAttribs(B57600, 0);
@@ -64,8 +66,11 @@ auto AilunceRadio::WriteFirmware(const std::string &file) -> void
 #endif
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
-    auto r = fw.GetDataSegments()[0];
-    device.Write(r.data);
+    const auto &r = fw.GetDataSegments()[0];
+    auto stream = fw::FirmwareStream(fw);
+    device.Write(r.size, [&stream](std::span<uint8_t> buf) {
+        return stream.Read(buf);
+    });
 }
 
 auto AilunceRadio::SupportsDevice(const std::string &port) -> bool
@@ -0,0 +1,181 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <radio_tool/util/checksum.hpp>
+
+#include <stdexcept>
+#include <typeinfo>
+
+using namespace radio_tool::checksum;
+
+/**
+ * Next as the same algorithm as this, to combine their states
+ */
+template <typename T>
+static auto SameAlgorithm(const Checksum& next) -> const T&
+{
+	auto ret = dynamic_cast<const T*>(&next);
+	if (ret == nullptr)
+	{
+		throw std::runtime_error("Cannot combine different checksum algorithms");
+	}
+	return *ret;
+}
+
+auto Checksum::Combine(const Checksum&) -> Checksum&
+{
+	throw std::runtime_error("Checksum cannot be combined");
+}
+
+auto BSD16Checksum::Init() -> void
+{
+	sum = 0;
+}
+
+auto BSD16Checksum::Update(std::span<const uint8_t> data) -> Checksum&
+{
+	sum = BSDChecksum(data, sum);
+	return *this;
+}
+
+auto BSD16Checksum::Finalize() const -> uint32_t
+{
+	return sum;
+}
+
+auto BSD16Checksum::Create() const -> std::unique_ptr<Checksum>
+{
+	return std::make_unique<BSD16Checksum>();
+}
+
+auto Fletcher16Checksum::Init() -> void
+{
+	sum = Fletcher16Sum();
+}
+
+auto Fletcher16Checksum::Update(std::span<const uint8_t> data) -> Checksum&
+{
+	sum.Update(data);
+	return *this;
+}
+
+auto Fletcher16Checksum::Finalize() const -> uint32_t
+{
+	return sum.Finalize();
+}
+
+auto Fletcher16Checksum::Combine(const Checksum& next) -> Checksum&
+{
+	sum.Combine(SameAlgorithm<Fletcher16Checksum>(next).sum);
+	return *this;
+}
+
+auto Fletcher16Checksum::Create() const -> std::unique_ptr<Checksum>
+{
+	return std::make_unique<Fletcher16Checksum>();
+}
+
+auto RFC1071Checksum::Init() -> void
+{
+	sum = InternetSum();
+}
+
+auto RFC1071Checksum::Update(std::span<const uint8_t> data) -> Checksum&
+{
+	sum.Update(data);
+	return *this;
+}
+
+auto RFC1071Checksum::Finalize() const -> uint32_t
+{
+	return sum.Finalize();
+}
+
+auto RFC1071Checksum::Combine(const Checksum& next) -> Checksum&
+{
+	sum.Combine(SameAlgorithm<RFC1071Checksum>(next).sum);
+	return *this;
+}
+
+auto RFC1071Checksum::Create() const -> std::unique_ptr<Checksum>
+{
+	return std::make_unique<RFC1071Checksum>();
+}
+
+auto ByteSumChecksum::Init() -> void
+{
+	sum = 0;
+}
+
+auto ByteSumChecksum::Update(std::span<const uint8_t> data) -> Checksum&
+{
+	sum += ByteSum(data);
+	return *this;
+}
+
+auto ByteSumChecksum::Combine(const Checksum& next) -> Checksum&
+{
+	//subclasses only differ in Finalize, but a CS sum still can't be added to an H8SX sum
+	if (typeid(next) != typeid(*this))
+	{
+		throw std::runtime_error("Cannot combine different checksum algorithms");
+	}
+	sum += static_cast<const ByteSumChecksum&>(next).sum;
+	return *this;
+}
+
+auto ConnectSystemsChecksum::Finalize() const -> uint32_t
+{
+	return CSChecksumFinalize(static_cast<uint16_t>(sum));
+}
+
+auto ConnectSystemsChecksum::Create() const -> std::unique_ptr<Checksum>
+{
+	return std::make_unique<ConnectSystemsChecksum>();
+}
+
+auto Sum32Checksum::Finalize() const -> uint32_t
+{
+	return static_cast<uint32_t>(sum);
+}
+
+auto Sum32Checksum::Create() const -> std::unique_ptr<Checksum>
+{
+	return std::make_unique<Sum32Checksum>();
+}
+
+auto H8SXChecksum::Finalize() const -> uint32_t
+{
+	return static_cast<uint8_t>(0u - sum);
+}
+
+auto H8SXChecksum::Create() const -> std::unique_ptr<Checksum>
+{
+	return std::make_unique<H8SXChecksum>();
+}
+
+auto radio_tool::checksum::GetChecksum(const std::string& name) -> std::unique_ptr<Checksum>
+{
+	for (const auto& c : AllChecksums)
+	{
+		if (c.Name == name)
+		{
+			return c.Create();
+		}
+	}
+	throw std::runtime_error("Checksum not found: " + name);
+}
@@ -0,0 +1,118 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <radio_tool/fw/cipher/cipher.hpp>
+#include <radio_tool/util/simd.hpp>
+#include <radio_tool/util/thread_pool.hpp>
+
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+
+using namespace radio_tool::fw::cipher;
+
+auto Cipher::Sum(const CipherDirection &dir, std::span<const uint8_t> buf, const uint64_t &offset) const -> uint64_t
+{
+    // multiple of every cipher alignment
+    uint8_t block[0x1000];
+    uint64_t sum = 0;
+    for (size_t x = 0; x < buf.size(); x += sizeof(block))
+    {
+        auto chunk = std::span<uint8_t>(block, std::min(sizeof(block), buf.size() - x));
+        std::copy_n(buf.begin() + x, chunk.size(), chunk.begin());
+        Apply(dir, chunk, offset + x);
+        sum += ByteSum(chunk);
+    }
+    return sum;
+}
+
+auto XORCipher::Apply(const CipherDirection &, std::span<uint8_t> buf, const uint64_t &offset) const -> void
+{
+    XORKeystream(buf, key, key_len, key_offset + offset);
+}
+
+auto XORCipher::Sum(const CipherDirection &, std::span<const uint8_t> buf, const uint64_t &offset) const -> uint64_t
+{
+    return XORKeystreamSum(buf, key, key_len, key_offset + offset);
+}
+
+auto SGLCipher::Apply(const CipherDirection &dir, std::span<uint8_t> buf, const uint64_t &offset) const -> void
+{
+    if (dir == CipherDirection::Decrypt)
+    {
+        SGLDecrypt(buf, key, key_len, key_offset + offset);
+    }
+    else
+    {
+        SGLEncrypt(buf, key, key_len, key_offset + offset);
+    }
+}
+
+auto AilunceCipher::Apply(const CipherDirection &, std::span<uint8_t> buf, const uint64_t &offset) const -> void
+{
+    // Whole words up to the last word of the binary, then the last bytes one at a time
+    auto words_end = size - (size % sizeof(uint32_t));
+    auto word_bytes = offset < words_end ? std::min<uint64_t>(buf.size(), words_end - offset) : 0;
+    if (offset % sizeof(uint32_t) != 0 || word_bytes % sizeof(uint32_t) != 0)
+    {
+        throw std::runtime_error("Ailunce cipher must be applied on word boundaries");
+    }
+
+    AilunceWords(buf.first(word_bytes));
+
+    // Last bytes, 0x00/0xff get 0xff and the rest 0x01 or 0x07 by bit 0
+    for (auto z = word_bytes; z < buf.size(); z++)
+    {
+        uint8_t m = 0x07 ^ ((buf[z] & 1) * 0x06);
+        m |= 0 - static_cast<uint8_t>(buf[z] == 0x00 || buf[z] == 0xff);
+        buf[z] ^= m;
+    }
+}
+
+auto radio_tool::fw::cipher::ParallelApply(const Cipher &cipher, const CipherDirection &dir, std::span<uint8_t> buf, const uint64_t &offset) -> void
+{
+    if (ParallelChunkSize % cipher.Alignment() != 0)
+    {
+        throw std::invalid_argument("Cipher alignment does not divide the chunk size");
+    }
+
+    ThreadPool::Global().ParallelFor(ParallelChunks(buf.size()), [&](const size_t &chunk) {
+        auto start = chunk * ParallelChunkSize;
+        cipher.Apply(dir, buf.subspan(start, std::min<size_t>(ParallelChunkSize, buf.size() - start)), offset + start);
+    });
+}
+
+auto radio_tool::fw::cipher::ParallelSum(const Cipher &cipher, const CipherDirection &dir, std::span<const uint8_t> buf, const uint64_t &offset) -> uint64_t
+{
+    if (ParallelChunkSize % cipher.Alignment() != 0)
+    {
+        throw std::invalid_argument("Cipher alignment does not divide the chunk size");
+    }
+
+    auto sums = std::vector<uint64_t>(ParallelChunks(buf.size()), 0);
+    ThreadPool::Global().ParallelFor(sums.size(), [&](const size_t &chunk) {
+        auto start = chunk * ParallelChunkSize;
+        sums[chunk] = cipher.Sum(dir, buf.subspan(start, std::min<size_t>(ParallelChunkSize, buf.size() - start)), offset + start);
+    });
+
+    uint64_t sum = 0;
+    for (const auto &s : sums)
+    {
+        sum += s;
+    }
+    return sum;
+}
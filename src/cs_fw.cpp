@@ -51,11 +51,17 @@ auto CSFW::Read(const std::string& fw) -> void
 			throw std::runtime_error("Invalid firmware header");
 		}
 
-		data.resize(header.imagesize);
-		in_file.read((char*)data.data(), header.imagesize);
+		in_file.seekg(sizeof(CS800D_header) + header.imagesize, std::fstream::beg);
 		in_file.read((char*)&checksum, sizeof(uint16_t));
 		in_file.close();
 
+		LoadPayload(fw, sizeof(CS800D_header), header.imagesize);
+		if (GetReadMode() == ReadMode::Streamed)
+		{
+			//the checksum covers the whole image
+			Materialize();
+		}
+
 		//xor checksum
 		((uint8_t*)&checksum)[0] = ((uint8_t*)&checksum)[0] ^ cipher::cs800_0[header.imagesize % cipher::cs800_length];
 		((uint8_t*)&checksum)[1] = ((uint8_t*)&checksum)[1] ^ cipher::cs800_0[(header.imagesize + 1) % cipher::cs800_length];
@@ -78,6 +84,8 @@ auto CSFW::Read(const std::string& fw) -> void
 
 auto CSFW::UpdateHeader() -> void
 {
+	Materialize();
+
 	if (memory_ranges.size() != 1)
 	{
 		throw std::runtime_error("CS Firmware can only contain one segment!");
@@ -97,12 +105,11 @@ auto CSFW::Write(const std::string& fw) -> void
 	if (of.is_open())
 	{
 		UpdateHeader();
-		auto data = MakeFiledata();
-		of.write((char*)data.data(), data.size());
+		auto binary = Binary();
+		of.write((char*)&header, sizeof(CS800D_header));
+		of.write((char*)binary.data(), binary.size());
 
-		//Apply XOR to make checksum
-		ApplyXOR(data.begin() + header.imageHeaderSize, data.end(), cipher::cs800_0, cipher::cs800_length);
-		auto cs = CSChecksum(data.begin(), data.end());
+		auto cs = MakeChecksum();
 
 		//XOR the checksum before writing
 		((uint8_t*)&cs)[0] = ((uint8_t*)&cs)[0] ^ cipher::cs800_0[header.imagesize % cipher::cs800_length];
@@ -148,14 +155,19 @@ auto CSFW::SetRadioModel(const std::string&) -> void
 
 auto CSFW::Decrypt() -> void
 {
-	//dont know how to detect dr5xx0 so just use cs800 cipher always
-	ApplyXOR(data, cipher::cs800_0, cipher::cs800_length);
+	Transform(CipherDirection::Decrypt);
 }
 
 auto CSFW::Encrypt() -> void
+{
+	Transform(CipherDirection::Encrypt);
+}
+
+auto CSFW::GetCipher() const -> std::shared_ptr<const cipher::Cipher>
 {
 	//dont know how to detect dr5xx0 so just use cs800 cipher always
-	ApplyXOR(data, cipher::cs800_0, cipher::cs800_length);
+	static const auto cs800 = std::make_shared<const cipher::XORCipher>(cipher::cs800_0, cipher::cs800_length);
+	return cs800;
 }
 
 auto CSFW::SupportsFirmwareFile(const std::string& file) -> bool
@@ -198,25 +210,20 @@ auto CSFW::SupportsRadioModel(const std::string& model) -> bool
 
 auto CSFW::MakeChecksum() const -> uint16_t
 {
-	//Make a copy of the firmware data because we will apply XOR
-	auto to_check = MakeFiledata();
-
-	//XOR firmware data
-	ApplyXOR(to_check.begin() + header.imageHeaderSize, to_check.end(), cipher::cs800_0, cipher::cs800_length);
-
-	return CSChecksum(to_check.begin(), to_check.end());
-}
-
-auto CSFW::MakeFiledata() const -> std::vector<uint8_t>
-{
-	auto h_ptr = (uint8_t*)&header;
-	std::vector<uint8_t> ret;
-	ret.reserve(header.imageHeaderSize + header.imagesize);
-
-	std::copy(h_ptr, h_ptr + sizeof(CS800D_header), std::back_inserter(ret));
-	std::copy(data.begin(), data.end(), std::back_inserter(ret));
-
-	return ret;
+	//sum the header and the XORed image in one read only pass
+	auto h_ptr = (const uint8_t*)&header;
+	auto image = Binary();
+	auto cs800 = GetCipher();
+	auto sum = ByteSum(std::span<const uint8_t>(h_ptr, sizeof(CS800D_header)));
+	if (GetExecutionMode() == ExecutionMode::Parallel)
+	{
+		sum += cipher::ParallelSum(*cs800, CipherDirection::Encrypt, image, 0);
+	}
+	else
+	{
+		sum += cs800->Sum(CipherDirection::Encrypt, image, 0);
+	}
+	return CSChecksumFinalize(static_cast<uint16_t>(sum));
 }
 
 auto CSFW::IsCompatible(const FirmwareSupport* Other) const -> bool
@@ -17,82 +17,219 @@
  */
 #include <radio_tool/dfu/dfu.hpp>
 #include <radio_tool/dfu/dfu_exception.hpp>
+#include <radio_tool/dfu/dfu_download_engine.hpp>
 
 #include <exception>
 #include <thread>
 #include <chrono>
+#include <algorithm>
 
 using namespace radio_tool::dfu;
+using namespace std::chrono;
 
 auto DFU::SetAddress(const uint32_t &addr) const -> void
 {
-    std::vector<uint8_t> data = {
+    const uint8_t data[] = {
         static_cast<uint8_t>(0x21),
         static_cast<uint8_t>(addr & 0xFF),
         static_cast<uint8_t>((addr >> 8) & 0xFF),
         static_cast<uint8_t>((addr >> 16) & 0xFF),
         static_cast<uint8_t>((addr >> 24) & 0xFF)};
 
-    Download(data);
+    Execute(data, 0, DFUOperation::Command, 0);
 }
 
-auto DFU::Erase(const uint32_t &addr) const -> void
+auto DFU::Erase(const uint32_t &addr, const uint32_t &size) const -> void
 {
-    std::vector<uint8_t> data = {
+    const uint8_t data[] = {
         static_cast<uint8_t>(0x41),
         static_cast<uint8_t>(addr & 0xFF),
         static_cast<uint8_t>((addr >> 8) & 0xFF),
         static_cast<uint8_t>((addr >> 16) & 0xFF),
         static_cast<uint8_t>((addr >> 24) & 0xFF)};
 
-    Download(data);
+    Execute(data, 0, DFUOperation::Erase, size);
 }
 
-auto DFU::Download(const std::vector<uint8_t> &data, const uint16_t &wValue) const -> void
+auto DFU::MassErase(const uint32_t &size) const -> void
+{
+    const uint8_t data[] = {static_cast<uint8_t>(0x41)};
+
+    Execute(data, 0, DFUOperation::Erase, size);
+}
+
+auto DFU::Download(std::span<const uint8_t> data, const uint16_t &wValue) const -> void
+{
+    //block downloads (wValue >= 2) program flash, lower wValue are DfuSe commands
+    Execute(data, wValue, wValue >= 2 ? DFUOperation::Program : DFUOperation::Command, static_cast<uint32_t>(data.size()));
+}
+
+auto DFU::Execute(std::span<const uint8_t> data, const uint16_t &wValue, const DFUOperation &op, const uint32_t &size) const -> void
 {
     InitDownload();
     // tehnically we shouldnt const_cast here but libusb *?WONT?* modify this data
     auto err = libusb_control_transfer(device, 0x21, static_cast<uint8_t>(DFURequest::DNLOAD), wValue, 0, const_cast<unsigned char *>(data.data()), data.size(), this->timeout);
     if (err < LIBUSB_SUCCESS)
     {
+        session.Invalidate();
         throw DFUException(libusb_error_name(err));
     }
+    session.Update(DFUState::DFU_DOWNLOAD_SYNC);
 
     //execute command by calling GetStatus
     auto status = GetStatus();
     if (status.state != DFUState::DFU_DOWNLOAD_BUSY)
     {
+        session.Invalidate();
         throw DFUException("Command execution failed");
     }
-    else if (status.timeout > 0)
+
+    WaitForIdle(status, op, size);
+}
+
+auto DFU::WaitForIdle(const DFUStatusReport &busy, const DFUOperation &op, const uint32_t &size) const -> void
+{
+    auto start = steady_clock::now();
+    auto hint = milliseconds(busy.timeout);
+    for (uint32_t attempt = 0;; attempt++)
     {
-        //std::this_thread::sleep_for(std::chrono::nanoseconds(status.timeout));
+        auto elapsed = duration_cast<microseconds>(steady_clock::now() - start);
+        if (elapsed > MaxBusy)
+        {
+            session.Invalidate();
+            throw DFUException("Timeout waiting for device");
+        }
+        std::this_thread::sleep_for(poll.NextPoll(op, size, hint, elapsed, attempt));
+
+        //check the command executed ok
+        auto status = GetStatus();
+        if (status.state == DFUState::DFU_DOWNLOAD_IDLE)
+        {
+            poll.Record(op, size, duration_cast<microseconds>(steady_clock::now() - start));
+            return;
+        }
+        if (status.state != DFUState::DFU_DOWNLOAD_BUSY || status.status != DFUStatus::OK)
+        {
+            session.Invalidate();
+            throw DFUException("Command execution failed");
+        }
+        hint = milliseconds(status.timeout);
     }
+}
 
-    //check the command executed ok
-    auto status2 = GetStatus();
-    if (status2.state != DFUState::DFU_DOWNLOAD_IDLE)
+auto DFU::DownloadBlocks(const uint8_t *data, const size_t &len, const uint16_t &transfer_size, const uint16_t &wValue) const -> void
+{
+    InitDownload();
+    if (usb_ctx != nullptr)
     {
-        throw DFUException("Command execution failed");
+        try
+        {
+            auto engine = DFUDownloadEngine(usb_ctx, device, timeout, poll);
+            engine.Download(data, len, transfer_size, wValue);
+        }
+        catch (const DFUException &)
+        {
+            session.Invalidate();
+            throw;
+        }
+        session.Update(DFUState::DFU_DOWNLOAD_IDLE);
+        return;
+    }
+
+    //no context to reap async transfers on, fall back to one block at a time
+    auto blocks = std::span<const uint8_t>(data, len);
+    for (size_t offset = 0, block = 0; offset < len; offset += transfer_size, block++)
+    {
+        Download(blocks.subspan(offset, std::min<size_t>(transfer_size, len - offset)), static_cast<uint16_t>(wValue + block));
     }
 }
 
-auto DFU::Upload(const uint16_t &size, const uint8_t &wValue) const -> std::vector<uint8_t>
+auto DFU::Upload(const uint16_t &size, const uint16_t &wValue) const -> std::vector<uint8_t>
 {
     InitUpload();
     auto data = std::vector<uint8_t>(size);
     auto err = libusb_control_transfer(device, 0xa1, static_cast<uint8_t>(DFURequest::UPLOAD), wValue, 0, data.data(), data.size(), this->timeout);
     if (err < LIBUSB_SUCCESS)
     {
+        session.Invalidate();
         throw DFUException(libusb_error_name(err));
     }
     else
     {
+        //a short frame ends the upload and the device returns to DFU_IDLE
+        session.Update(static_cast<size_t>(err) < data.size() ? DFUState::DFU_IDLE : DFUState::DFU_UPLOAD_IDLE);
         data.resize(err);
     }
     return data;
 }
 
+auto DFU::UploadBlocks(uint8_t *data, const size_t &len, const uint16_t &transfer_size, const uint16_t &wValue) const -> void
+{
+    for (size_t offset = 0, block = 0; offset < len; offset += transfer_size, block++)
+    {
+        auto size = static_cast<uint16_t>(std::min<size_t>(transfer_size, len - offset));
+        auto rx = Upload(size, static_cast<uint16_t>(wValue + block));
+        if (rx.size() != size)
+        {
+            throw DFUException("Short upload");
+        }
+        std::copy(rx.begin(), rx.end(), data + offset);
+    }
+}
+
+auto DFU::ReadFunctionalDescriptor(libusb_device_handle *device) -> std::optional<DFUFunctionalDescriptor>
+{
+    if (device == nullptr)
+    {
+        return {};
+    }
+
+    libusb_config_descriptor *config = nullptr;
+    if (libusb_get_active_config_descriptor(libusb_get_device(device), &config) != LIBUSB_SUCCESS)
+    {
+        return {};
+    }
+
+    auto find = [](const unsigned char *extra, const int &len) -> std::optional<DFUFunctionalDescriptor> {
+        for (auto x = 0; x + 1 < len && extra[x] > 0; x += extra[x])
+        {
+            if (extra[x + 1] == DFUFunctionalDescriptor::DescriptorType && extra[x] >= DFUFunctionalDescriptor::DescriptorSize && x + DFUFunctionalDescriptor::DescriptorSize <= len)
+            {
+                return DFUFunctionalDescriptor::Parse(extra + x);
+            }
+        }
+        return {};
+    };
+
+    //normally follows the DFU interface descriptor, some devices put it on the configuration
+    std::optional<DFUFunctionalDescriptor> ret;
+    for (auto i = 0; i < config->bNumInterfaces && !ret; i++)
+    {
+        const auto &iface = config->interface[i];
+        for (auto a = 0; a < iface.num_altsetting && !ret; a++)
+        {
+            const auto &alt = iface.altsetting[a];
+            if (alt.bInterfaceClass == 0xfe && alt.bInterfaceSubClass == 0x01)
+            {
+                if (auto desc = find(alt.extra, alt.extra_length))
+                {
+                    ret.emplace(desc.value());
+                }
+            }
+        }
+    }
+    if (!ret)
+    {
+        if (auto desc = find(config->extra, config->extra_length))
+        {
+            ret.emplace(desc.value());
+        }
+    }
+
+    libusb_free_config_descriptor(config);
+    return ret;
+}
+
 auto DFU::GetState() const -> DFUState
 {
     CheckDevice();
@@ -100,11 +237,13 @@ auto DFU::GetState() const -> DFUState
     auto err = libusb_control_transfer(device, 0xa1, static_cast<uint8_t>(DFURequest::GETSTATE), 0, 0, &state, 1, this->timeout);
     if (err < LIBUSB_SUCCESS)
     {
+        session.Invalidate();
         throw DFUException(libusb_error_name(err));
     }
     else
     {
         auto s = static_cast<DFUState>((int)state);
+        session.Update(s);
         //std::cerr << "State: " << ::ToString(s) << std::endl;
         return s;
     }
@@ -119,11 +258,14 @@ auto DFU::GetStatus() const -> const DFUStatusReport
     auto err = libusb_control_transfer(device, 0xa1, static_cast<uint8_t>(DFURequest::GETSTATUS), 0, 0, data, StatusSize, this->timeout);
     if (err < LIBUSB_SUCCESS)
     {
+        session.Invalidate();
         throw DFUException(libusb_error_name(err));
     }
     else
     {
-        return DFUStatusReport::Parse(data);
+        auto report = DFUStatusReport::Parse(data);
+        session.Update(report);
+        return report;
     }
     return DFUStatusReport::Empty();
 }
@@ -131,17 +273,42 @@ auto DFU::GetStatus() const -> const DFUStatusReport
 auto DFU::Abort() const -> void
 {
     CheckDevice();
+    //states DFU_ABORT is valid from, anywhere else the device may stay where it is
+    auto valid = session.IsIn({DFUState::DFU_IDLE, DFUState::DFU_DOWNLOAD_SYNC, DFUState::DFU_DOWNLOAD_IDLE,
+                               DFUState::DFU_MANIFEST_SYNC, DFUState::DFU_UPLOAD_IDLE});
     auto err = libusb_control_transfer(device, 0x21, static_cast<uint8_t>(DFURequest::ABORT), 0, 0, nullptr, 0, this->timeout);
     if (err < LIBUSB_SUCCESS)
     {
+        session.Invalidate();
         throw DFUException(libusb_error_name(err));
     }
+    if (valid)
+    {
+        session.Update(DFUState::DFU_IDLE);
+    }
+    else
+    {
+        session.Invalidate();
+    }
+}
+
+auto DFU::ClearStatus() const -> void
+{
+    CheckDevice();
+    auto err = libusb_control_transfer(device, 0x21, static_cast<uint8_t>(DFURequest::CLRSTATUS), 0, 0, nullptr, 0, this->timeout);
+    if (err < LIBUSB_SUCCESS)
+    {
+        session.Invalidate();
+        throw DFUException(libusb_error_name(err));
+    }
+    session.Update(DFUState::DFU_IDLE);
 }
 
 auto DFU::Detach() const -> void
 {
     CheckDevice();
     auto err = libusb_control_transfer(device, 0x21, static_cast<uint8_t>(DFURequest::DETACH), 0, 0, nullptr, 0, this->timeout);
+    session.Invalidate();
     if (err < LIBUSB_SUCCESS)
     {
         throw DFUException(libusb_error_name(err));
@@ -157,39 +324,39 @@ auto DFU::CheckDevice() const -> void
 auto DFU::InitDownload() const -> void
 {
     CheckDevice();
-    while (1)
+    while (!session.IsIn({DFUState::DFU_DOWNLOAD_IDLE, DFUState::DFU_IDLE}))
     {
-        auto state = GetState();
-        switch (state)
+        //only ask the device when we lost track of its state
+        if (!session.State().has_value())
         {
-        case DFUState::DFU_DOWNLOAD_IDLE:
-        case DFUState::DFU_IDLE:
-            return;
-        default:
-        {
-            Abort();
-            break;
+            GetState();
+            continue;
         }
+        if (session.IsIn({DFUState::DFU_ERROR}))
+        {
+            ClearStatus();
+            continue;
         }
+        Abort();
     }
 }
 
 auto DFU::InitUpload() const -> void
 {
     CheckDevice();
-    while (1)
+    while (!session.IsIn({DFUState::DFU_UPLOAD_IDLE, DFUState::DFU_IDLE}))
     {
-        auto state = GetState();
-        switch (state)
+        //only ask the device when we lost track of its state
+        if (!session.State().has_value())
         {
-        case DFUState::DFU_UPLOAD_IDLE:
-        case DFUState::DFU_IDLE:
-            return;
-        default:
-        {
-            Abort();
-            break;
+            GetState();
+            continue;
         }
+        if (session.IsIn({DFUState::DFU_ERROR}))
+        {
+            ClearStatus();
+            continue;
         }
+        Abort();
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,272 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <radio_tool/dfu/dfu_download_engine.hpp>
+#include <radio_tool/dfu/dfu_exception.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+using namespace radio_tool::dfu;
+using namespace std::chrono;
+
+DFUDownloadEngine::DFUDownloadEngine(libusb_context *ctx, libusb_device_handle *device, const uint16_t &timeout, const DFUPollScheduler &poll)
+    : ctx(ctx), device(device), timeout(timeout), poll(poll), dnload{nullptr, nullptr}, status(nullptr), status_buffer{},
+      data(nullptr), len(0), block(0), blocks(0), transfer_size(0), first_block(0), active(0), stage(Stage::Download),
+      attempt(0), poll_pending(false), prepared(false), completed(1)
+{
+    dnload[0] = libusb_alloc_transfer(0);
+    dnload[1] = libusb_alloc_transfer(0);
+    status = libusb_alloc_transfer(0);
+    if (dnload[0] == nullptr || dnload[1] == nullptr || status == nullptr)
+    {
+        libusb_free_transfer(dnload[0]);
+        libusb_free_transfer(dnload[1]);
+        libusb_free_transfer(status);
+        throw DFUException(libusb_error_name(LIBUSB_ERROR_NO_MEM));
+    }
+
+    //status requests never change, fill them once
+    libusb_fill_control_setup(status_buffer, 0xa1, static_cast<uint8_t>(DFURequest::GETSTATUS), 0, 0, StatusSize);
+    libusb_fill_control_transfer(status, device, status_buffer, &DFUDownloadEngine::OnTransfer, this, timeout);
+}
+
+DFUDownloadEngine::~DFUDownloadEngine()
+{
+    //transfers are chained one at a time, nothing is in flight once Download returns
+    libusb_free_transfer(dnload[0]);
+    libusb_free_transfer(dnload[1]);
+    libusb_free_transfer(status);
+}
+
+auto DFUDownloadEngine::Download(const uint8_t *data, const size_t &len, const uint16_t &transfer_size, const uint16_t &wValue) -> void
+{
+    if (transfer_size == 0)
+    {
+        throw DFUException("Invalid transfer size");
+    }
+    if (len == 0)
+    {
+        return;
+    }
+
+    this->data = data;
+    this->len = len;
+    this->transfer_size = transfer_size;
+    this->first_block = wValue;
+    this->blocks = (len + transfer_size - 1) / transfer_size;
+    this->block = 0;
+    this->active = 0;
+    this->stage = Stage::Download;
+    this->error.clear();
+    this->poll_pending = false;
+    this->prepared = false;
+    this->completed = 0;
+
+    for (auto &buf : dnload_buffer)
+    {
+        buf.resize(LIBUSB_CONTROL_SETUP_SIZE + transfer_size);
+    }
+
+    Prepare(active, block);
+    Submit(dnload[active]);
+    WaitEvents();
+
+    //callbacks hand back to us while the device is busy, so the wait doesnt block the event thread
+    while (poll_pending && error.empty())
+    {
+        poll_pending = false;
+        if (!prepared && block + 1 < blocks)
+        {
+            Prepare(active ^ 1, block + 1);
+            prepared = true;
+        }
+        std::this_thread::sleep_until(poll_at);
+
+        completed = 0;
+        Submit(status);
+        WaitEvents();
+    }
+
+    if (!error.empty())
+    {
+        throw DFUException(error);
+    }
+}
+
+auto DFUDownloadEngine::WaitEvents() -> void
+{
+    while (!completed)
+    {
+        auto err = libusb_handle_events_completed(ctx, &completed);
+        if (err != LIBUSB_SUCCESS && err != LIBUSB_ERROR_INTERRUPTED)
+        {
+            //cant reap our transfers anymore, dont leave one pointing at this object
+            libusb_cancel_transfer(stage == Stage::Download ? dnload[active] : status);
+            while (!completed)
+            {
+                libusb_handle_events_completed(ctx, &completed);
+            }
+            poll_pending = false;
+            throw DFUException(libusb_error_name(err));
+        }
+    }
+}
+
+void LIBUSB_CALL DFUDownloadEngine::OnTransfer(libusb_transfer *tx)
+{
+    auto self = static_cast<DFUDownloadEngine *>(tx->user_data);
+    self->HandleTransfer(tx);
+}
+
+auto DFUDownloadEngine::HandleTransfer(libusb_transfer *tx) -> void
+{
+    if (tx->status != LIBUSB_TRANSFER_COMPLETED)
+    {
+        switch (tx->status)
+        {
+        case LIBUSB_TRANSFER_TIMED_OUT:
+            Finish(libusb_error_name(LIBUSB_ERROR_TIMEOUT));
+            break;
+        case LIBUSB_TRANSFER_STALL:
+            Finish(libusb_error_name(LIBUSB_ERROR_PIPE));
+            break;
+        case LIBUSB_TRANSFER_NO_DEVICE:
+            Finish(libusb_error_name(LIBUSB_ERROR_NO_DEVICE));
+            break;
+        case LIBUSB_TRANSFER_OVERFLOW:
+            Finish(libusb_error_name(LIBUSB_ERROR_OVERFLOW));
+            break;
+        default:
+            Finish(libusb_error_name(LIBUSB_ERROR_IO));
+            break;
+        }
+        return;
+    }
+
+    switch (stage)
+    {
+    case Stage::Download:
+    {
+        //execute command by calling GetStatus
+        stage = Stage::StatusBusy;
+        Submit(status);
+        break;
+    }
+    case Stage::StatusBusy:
+    {
+        if (tx->actual_length < StatusSize)
+        {
+            Finish("Short status response");
+            return;
+        }
+        auto report = DFUStatusReport::Parse(libusb_control_transfer_get_data(tx));
+        if (report.state != DFUState::DFU_DOWNLOAD_BUSY)
+        {
+            Finish("Command execution failed");
+            return;
+        }
+
+        //wait for the device to go idle, the next block is prepared while it is busy
+        stage = Stage::StatusIdle;
+        busy_since = steady_clock::now();
+        attempt = 0;
+        SchedulePoll(report);
+        break;
+    }
+    case Stage::StatusIdle:
+    {
+        if (tx->actual_length < StatusSize)
+        {
+            Finish("Short status response");
+            return;
+        }
+        auto report = DFUStatusReport::Parse(libusb_control_transfer_get_data(tx));
+        if (report.state == DFUState::DFU_DOWNLOAD_BUSY && report.status == DFUStatus::OK)
+        {
+            attempt++;
+            SchedulePoll(report);
+            return;
+        }
+        if (report.state != DFUState::DFU_DOWNLOAD_IDLE)
+        {
+            Finish("Command execution failed");
+            return;
+        }
+        poll.Record(DFUOperation::Program, transfer_size, duration_cast<microseconds>(steady_clock::now() - busy_since));
+
+        if (++block == blocks)
+        {
+            Finish();
+            return;
+        }
+
+        if (!prepared)
+        {
+            Prepare(active ^ 1, block);
+        }
+        prepared = false;
+        active ^= 1;
+        stage = Stage::Download;
+        Submit(dnload[active]);
+        break;
+    }
+    }
+}
+
+auto DFUDownloadEngine::SchedulePoll(const DFUStatusReport &report) -> void
+{
+    auto now = steady_clock::now();
+    auto elapsed = duration_cast<microseconds>(now - busy_since);
+    if (elapsed > MaxBusy)
+    {
+        Finish("Timeout waiting for device");
+        return;
+    }
+
+    poll_at = now + poll.NextPoll(DFUOperation::Program, transfer_size, milliseconds(report.timeout), elapsed, attempt);
+    poll_pending = true;
+    completed = 1;
+}
+
+auto DFUDownloadEngine::Prepare(const uint8_t &slot, const size_t &blk) -> void
+{
+    auto offset = blk * transfer_size;
+    auto size = static_cast<uint16_t>(std::min<size_t>(transfer_size, len - offset));
+    auto buf = dnload_buffer[slot].data();
+
+    libusb_fill_control_setup(buf, 0x21, static_cast<uint8_t>(DFURequest::DNLOAD), static_cast<uint16_t>(first_block + blk), 0, size);
+    memcpy(buf + LIBUSB_CONTROL_SETUP_SIZE, data + offset, size);
+    libusb_fill_control_transfer(dnload[slot], device, buf, &DFUDownloadEngine::OnTransfer, this, timeout);
+}
+
+auto DFUDownloadEngine::Submit(libusb_transfer *tx) -> void
+{
+    auto err = libusb_submit_transfer(tx);
+    if (err != LIBUSB_SUCCESS)
+    {
+        Finish(libusb_error_name(err));
+    }
+}
+
+auto DFUDownloadEngine::Finish(const std::string &err) -> void
+{
+    error = err;
+    poll_pending = false;
+    completed = 1;
+}
@@ -0,0 +1,139 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <radio_tool/dfu/dfu_erase_planner.hpp>
+#include <radio_tool/dfu/dfu_poll_scheduler.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+using namespace radio_tool::dfu;
+using namespace std::chrono;
+
+/**
+ * STM32F4 typical erase times (x32 parallelism), 16k = 250ms, 64k = 550ms, 128k = 1s
+ * which is close to linear in the sector size
+ */
+constexpr auto SectorEraseBase = microseconds(143000);
+constexpr auto SectorErasePerKiB = microseconds(6700);
+
+/**
+ * STM32F4 typical mass erase time (x32 parallelism)
+ */
+constexpr auto MassEraseDefault = microseconds(8000000);
+
+/**
+ * DNLOAD + GETSTATUS round trips around each erase
+ */
+constexpr auto CommandOverhead = microseconds(10000);
+
+auto ErasePlan::ToString() const -> std::string
+{
+    std::stringstream out;
+    out << "ErasePlan[Strategy=" << dfu::ToString(strategy)
+        << ", Sectors=" << std::dec << sectors.size()
+        << ", Estimate=" << duration_cast<milliseconds>(estimate).count() << "ms"
+        << ", SectorsEstimate=" << duration_cast<milliseconds>(sectors_estimate).count() << "ms"
+        << "]";
+    return out.str();
+}
+
+auto DFUErasePlanner::EstimateSector(const flash::FlashSector &sector) const -> microseconds
+{
+    if (auto t = DFUTimingTable::Global().Get(model, DFUOperation::Erase, sector.size))
+    {
+        return t->average + CommandOverhead;
+    }
+    return SectorEraseBase + SectorErasePerKiB * (sector.size / 1024) + CommandOverhead;
+}
+
+auto DFUErasePlanner::EstimateMass() const -> microseconds
+{
+    if (auto t = DFUTimingTable::Global().Get(model, DFUOperation::Erase, MassEraseSize()))
+    {
+        return t->average + CommandOverhead;
+    }
+    return MassEraseDefault + CommandOverhead;
+}
+
+auto DFUErasePlanner::Plan(const std::vector<std::pair<uint32_t, uint32_t>> &ranges) const -> ErasePlan
+{
+    auto plan = ErasePlan{EraseStrategy::None, {}, microseconds(0), microseconds(0)};
+
+    //every sector touched by any range, once and in order
+    std::vector<uint16_t> touched;
+    for (const auto &[start, size] : ranges)
+    {
+        flash::FlashUtil::AlignedContiguousMemoryOp(map, start, start + size,
+            [&](const uint32_t &, const uint32_t &, const flash::FlashSector &sector) {
+                touched.push_back(sector.index);
+            });
+    }
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+    for (const auto &idx : touched)
+    {
+        if (std::find(protected_sectors.begin(), protected_sectors.end(), idx) != protected_sectors.end())
+        {
+            std::stringstream msg;
+            msg << "Firmware overlaps protected sector " << idx;
+            throw std::runtime_error(msg.str());
+        }
+
+        auto sector = map.Sector(idx).value();
+        plan.sectors_estimate += EstimateSector(sector);
+        plan.sectors.push_back(sector);
+    }
+
+    if (plan.sectors.empty())
+    {
+        return plan;
+    }
+
+    plan.strategy = EraseStrategy::Sectors;
+    plan.estimate = plan.sectors_estimate;
+    if (mass_erase && protected_sectors.empty() && plan.sectors.size() == map.Sectors())
+    {
+        auto mass = EstimateMass();
+        if (mass < plan.estimate)
+        {
+            plan.strategy = EraseStrategy::Mass;
+            plan.estimate = mass;
+        }
+    }
+    return plan;
+}
+
+auto DFUErasePlanner::Execute(const DFU &dfu, const ErasePlan &plan) const -> void
+{
+    switch (plan.strategy)
+    {
+    case EraseStrategy::None:
+        break;
+    case EraseStrategy::Sectors:
+        for (const auto &sector : plan.sectors)
+        {
+            dfu.Erase(sector.start, sector.size);
+        }
+        break;
+    case EraseStrategy::Mass:
+        dfu.MassErase(MassEraseSize());
+        break;
+    }
+}
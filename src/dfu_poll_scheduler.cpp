@@ -0,0 +1,122 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <radio_tool/dfu/dfu_poll_scheduler.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+using namespace radio_tool::dfu;
+using namespace std::chrono;
+
+/**
+ * Backoff when nothing is known about the operation (1ms, 2ms, 4ms .. 64ms)
+ */
+constexpr auto MinBackoff = microseconds(1000);
+constexpr auto MaxBackoffShift = 6u;
+
+/**
+ * Wake up this much before the learned busy time, so a slightly faster
+ * operation doesnt wait for a whole average
+ */
+constexpr auto EarlyWakeDivisor = 8;
+
+auto DFUTimingTable::Global() -> DFUTimingTable &
+{
+    static DFUTimingTable table;
+    return table;
+}
+
+auto DFUTimingTable::Record(const std::string &model, const DFUOperation &op, const uint32_t &size, const microseconds &busy) -> void
+{
+    std::lock_guard<std::mutex> lk(lock);
+
+    auto key = Key(model, op, size);
+    auto it = timings.find(key);
+    if (it == timings.end())
+    {
+        timings.emplace(key, DFUTiming{busy, busy, busy, 1});
+        return;
+    }
+
+    //exponential moving average, alpha = 1/4
+    auto &t = it->second;
+    t.average = (t.average * 3 + busy) / 4;
+    t.min = std::min(t.min, busy);
+    t.max = std::max(t.max, busy);
+    t.samples++;
+}
+
+auto DFUTimingTable::Get(const std::string &model, const DFUOperation &op, const uint32_t &size) const -> std::optional<DFUTiming>
+{
+    std::lock_guard<std::mutex> lk(lock);
+
+    auto it = timings.find(Key(model, op, size));
+    if (it != timings.end())
+    {
+        return it->second;
+    }
+    return {};
+}
+
+auto DFUTimingTable::ToString() const -> std::string
+{
+    std::lock_guard<std::mutex> lk(lock);
+
+    std::stringstream out;
+    out << "== DFU Timing ==" << std::endl;
+    for (const auto &[key, t] : timings)
+    {
+        const auto &[model, op, size] = key;
+        out << model << ": " << radio_tool::dfu::ToString(op)
+            << " [Size=0x" << std::hex << size << std::dec << "]"
+            << " Avg=" << std::fixed << std::setprecision(2) << (t.average.count() / 1000.0) << "ms"
+            << ", Min=" << (t.min.count() / 1000.0) << "ms"
+            << ", Max=" << (t.max.count() / 1000.0) << "ms"
+            << ", Samples=" << t.samples << std::endl;
+    }
+    return out.str();
+}
+
+auto DFUPollScheduler::NextPoll(const DFUOperation &op, const uint32_t &size, const milliseconds &hint,
+                                const microseconds &elapsed, const uint32_t &attempt) const -> microseconds
+{
+    auto min_wait = duration_cast<microseconds>(hint);
+    if (auto learned = DFUTimingTable::Global().Get(model, op, size))
+    {
+        auto expected = learned->average - (learned->average / EarlyWakeDivisor);
+        if (expected > elapsed)
+        {
+            return std::max(min_wait, expected - elapsed);
+        }
+    }
+
+    //first poll after the hint, if the device gave one
+    if (attempt == 0 && min_wait.count() > 0)
+    {
+        return min_wait;
+    }
+
+    auto backoff = MinBackoff * (1u << std::min(attempt, MaxBackoffShift));
+    return std::max(min_wait, backoff);
+}
+
+auto DFUPollScheduler::Record(const DFUOperation &op, const uint32_t &size, const microseconds &busy) const -> void
+{
+    DFUTimingTable::Global().Record(model, op, size, busy);
+}
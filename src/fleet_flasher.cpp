@@ -0,0 +1,210 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2020 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <radio_tool/radio/fleet_flasher.hpp>
+
+#include <memory>
+#include <thread>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <streambuf>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace radio_tool::radio;
+
+namespace
+{
+	/**
+	 * Collects a worker's output into lines and writes each complete line to std::cerr with a prefix,
+	 * so lines from different radios never mix
+	 */
+	class PrefixedLineBuf : public std::streambuf
+	{
+	public:
+		explicit PrefixedLineBuf(const std::string &prefix) : prefix(prefix), line() {}
+
+		~PrefixedLineBuf()
+		{
+			if (!line.empty())
+			{
+				line.push_back('\n');
+				Emit();
+			}
+		}
+
+	protected:
+		auto overflow(int_type ch) -> int_type override
+		{
+			if (traits_type::eq_int_type(ch, traits_type::eof()))
+			{
+				return traits_type::not_eof(ch);
+			}
+			line.push_back(traits_type::to_char_type(ch));
+			if (ch == '\n')
+			{
+				Emit();
+			}
+			return ch;
+		}
+
+	private:
+		const std::string prefix;
+		std::string line;
+
+		auto Emit() -> void
+		{
+			static std::mutex cerr_lock;
+			auto lk = std::lock_guard<std::mutex>(cerr_lock);
+			std::cerr << prefix << line << std::flush;
+			line.clear();
+		}
+	};
+}
+
+FleetFlasher::FleetFlasher(const RadioFactory &radios, const size_t &port_limit)
+	: radios(radios), port_limit(std::max<size_t>(port_limit, 1))
+{
+}
+
+auto FleetFlasher::Run(const std::vector<uint16_t> &indexes, const FleetJob &job) -> std::vector<FleetResult>
+{
+	const auto &devices = radios.ListDevices();
+	auto selected = std::vector<const RadioInfo *>();
+	if (indexes.empty())
+	{
+		for (const auto &d : devices)
+		{
+			selected.push_back(d.get());
+		}
+	}
+	else
+	{
+		for (const auto &idx : indexes)
+		{
+			if (idx >= devices.size())
+			{
+				std::stringstream msg;
+				msg << "Invalid device index: " << idx;
+				throw std::runtime_error(msg.str());
+			}
+			if (std::find(selected.begin(), selected.end(), devices[idx].get()) == selected.end())
+			{
+				selected.push_back(devices[idx].get());
+			}
+		}
+	}
+
+	auto results = std::vector<FleetResult>(selected.size());
+	auto workers = std::vector<std::thread>();
+	workers.reserve(selected.size());
+	for (size_t x = 0; x < selected.size(); x++)
+	{
+		workers.emplace_back([this, &selected, &results, &job, x]()
+							 { results[x] = Work(*selected[x], job); });
+	}
+	for (auto &w : workers)
+	{
+		w.join();
+	}
+	return results;
+}
+
+auto FleetFlasher::WriteFirmware(const std::vector<uint16_t> &indexes, const std::string &file) -> std::vector<FleetResult>
+{
+	return Run(indexes, [&file](RadioOperations &radio)
+			   { radio.WriteFirmware(file); });
+}
+
+auto FleetFlasher::Work(const RadioInfo &info, const FleetJob &job) -> FleetResult
+{
+	auto slot = PortSlot(*this, PortKey(info));
+
+	auto prefix = std::stringstream();
+	prefix << "[" << std::setfill('0') << std::setw(3) << info.index << "] ";
+	auto buf = PrefixedLineBuf(prefix.str());
+	auto log = std::ostream(&buf);
+
+	auto start = std::chrono::steady_clock::now();
+	auto result = FleetResult{info.index, info.ToString(), false, "", std::chrono::milliseconds(0)};
+	try
+	{
+		auto radio = info.OpenDevice();
+		if (radio == nullptr)
+		{
+			throw std::runtime_error("Device not found");
+		}
+		radio->SetLog(log);
+		job(*radio);
+		result.success = true;
+	}
+	catch (const std::exception &ex)
+	{
+		result.error = ex.what();
+	}
+	catch (...)
+	{
+		result.error = "Unknown error";
+	}
+	result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+	return result;
+}
+
+FleetFlasher::PortSlot::PortSlot(FleetFlasher &fleet, const uint32_t &port)
+	: fleet(fleet), port(port)
+{
+	auto lk = std::unique_lock<std::mutex>(fleet.lock);
+	fleet.slot_free.wait(lk, [&fleet, &port]()
+						 { return fleet.active[port] < fleet.port_limit; });
+	fleet.active[port]++;
+}
+
+FleetFlasher::PortSlot::~PortSlot()
+{
+	{
+		auto lk = std::lock_guard<std::mutex>(fleet.lock);
+		fleet.active[port]--;
+	}
+	fleet.slot_free.notify_all();
+}
+
+auto FleetFlasher::PortKey(const RadioInfo &info) -> uint32_t
+{
+	auto usb = dynamic_cast<const USBRadioInfo *>(&info);
+	if (usb != nullptr)
+	{
+		return usb->bus << 8 | usb->root_port;
+	}
+	return 0x10000 | info.index;
+}
+
+auto FleetResult::ToString() const -> const std::wstring
+{
+	std::wstringstream os;
+	os << device << L": ";
+	if (success)
+	{
+		os << L"OK";
+	}
+	else
+	{
+		os << L"FAILED (" << std::wstring(error.begin(), error.end()) << L")";
+	}
+	os << L" in " << std::dec << duration.count() << L"ms";
+	return os.str();
+}
@@ -0,0 +1,130 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <radio_tool/fw/fw_stream.hpp>
+
+using namespace radio_tool::fw;
+
+FirmwareStream::FirmwareStream(const FirmwareSupport& fw, const flash::FlashMap& map, const uint32_t& block_size, const size_t& depth)
+	: fw(fw), map(map), block_size(block_size), cipher(fw.pending ? fw.GetCipher() : nullptr), queue(depth), current_pos(0)
+{
+	if (block_size == 0 || depth == 0)
+	{
+		throw std::invalid_argument("Block size and depth must not be 0");
+	}
+	if (cipher && block_size % cipher->Alignment() != 0)
+	{
+		throw std::invalid_argument("Block size must be a multiple of the cipher alignment");
+	}
+	reader = std::thread(&FirmwareStream::Produce, this);
+}
+
+FirmwareStream::~FirmwareStream()
+{
+	//stops the reader if the consumer gave up early
+	queue.Close();
+	if (reader.joinable())
+	{
+		reader.join();
+	}
+}
+
+auto FirmwareStream::Next() -> std::optional<FirmwareBlock>
+{
+	return queue.Pop();
+}
+
+auto FirmwareStream::Read(std::span<uint8_t> out) -> size_t
+{
+	auto n = 0u;
+	while (n < out.size())
+	{
+		if (!current || current_pos == current->data.size())
+		{
+			current.reset();
+			current_pos = 0;
+			auto block = Next();
+			if (!block)
+			{
+				break;
+			}
+			current.emplace(std::move(block.value()));
+		}
+
+		auto len = std::min(out.size() - n, current->data.size() - current_pos);
+		std::copy_n(current->data.begin() + current_pos, len, out.begin() + n);
+		current_pos += len;
+		n += len;
+	}
+	return n;
+}
+
+auto FirmwareStream::TransformBlock(const CipherDirection& dir, std::span<uint8_t> buf, const FirmwareBlock& block) const -> void
+{
+	fw.TransformSegment(dir, buf, block.offset);
+}
+
+auto FirmwareStream::Produce() -> void
+{
+	try
+	{
+		std::ifstream in;
+		auto open = true;
+		auto emit = [&](const uint16_t& segment, const uint32_t& addr, const uint32_t& offset, const uint32_t& size,
+			const std::optional<flash::FlashSector>& sector) {
+			if (!open)
+			{
+				return;
+			}
+
+			auto block = FirmwareBlock{ segment, addr, offset, sector, std::vector<uint8_t>(size) };
+			fw.ReadPayload(in, offset, block.data);
+			if (cipher)
+			{
+				cipher->Apply(fw.pending.value(), block.data, offset);
+			}
+			open = queue.Push(std::move(block));
+		};
+
+		auto offset = 0u;
+		auto index = 0u;
+		for (const auto& [start, size] : fw.memory_ranges)
+		{
+			if (map.empty())
+			{
+				for (auto pos = 0u; pos < size; pos += block_size)
+				{
+					emit(index, start + pos, offset + pos, std::min(block_size, size - pos), {});
+				}
+			}
+			else
+			{
+				flash::FlashUtil::AlignedContiguousMemoryOp(map, start, start + size,
+					[&](const uint32_t& addr, const uint32_t& n, const flash::FlashSector& sector) {
+						emit(index, addr, offset + (addr - start), n, sector);
+					});
+			}
+			offset += size;
+			index++;
+		}
+		queue.Close();
+	}
+	catch (...)
+	{
+		queue.Fail(std::current_exception());
+	}
+}
@@ -23,6 +23,7 @@
 #include <exception>
 #include <thread>
 #include "radio_tool/util.hpp"
+#include <radio_tool/util/checksum.hpp>
 
 using namespace radio_tool::h8sx;
 
@@ -44,21 +45,34 @@ auto H8SX::IdentifyDevice() const -> std::string
     return dev_str.str();
 }
 
-auto H8SX::Download(const std::vector<uint8_t> &data) const -> void
+auto H8SX::Download(std::span<const uint8_t> data) const -> void
+{
+    BeginDownload();
+    EndDownload(Program(0, data));
+}
+
+auto H8SX::BeginDownload() const -> void
+{
+    InitDownload();
+}
+
+auto H8SX::Program(const uint32_t &addr, std::span<const uint8_t> data) const -> uint32_t
 {
     int err = 0;
     int transferred = 0, received = 0;
     uint8_t buf[BUF_SIZE];
 
-    InitDownload();
+    if (addr % 1024 != 0 || data.size() % 1024 != 0)
+    {
+        throw H8SXException("Programming must be done in whole 1KiB blocks");
+    }
 
     // 128-Byte Programming 0x50 ->
     struct prog_chunk_t c = {};
-    uint8_t cmd = static_cast<uint8_t>(H8SXCmd::PROGRAM_128B);
     uint32_t bin_sum = 0;
-    for (std::vector<uint8_t>::size_type i = 0; i < data.size() / 1024; i++)
+    for (size_t i = 0; i < data.size() / 1024; i++)
     {
-        c.addr = bswap32(i * 1024);
+        c.addr = bswap32(addr + i * 1024);
         std::copy(data.begin() + i * 1024, data.begin() + (i + 1) * 1024, c.data);
         bin_sum += Checksum((uint8_t *)&(c.data), 1024);
         c.sum = Checksum((uint8_t *)&c, sizeof(c) - 1);
@@ -72,6 +86,14 @@ auto H8SX::Download(const std::vector<uint8_t> &data) const -> void
             err = -1;
         CHECK_ERR("error during programming!");
     }
+    return bin_sum;
+}
+
+auto H8SX::EndDownload(const uint32_t &bin_sum) const -> void
+{
+    int err = 0;
+    int transferred = 0, received = 0;
+    uint8_t buf[BUF_SIZE];
 
     // Send 1024 and then last 6
 
@@ -88,7 +110,7 @@ auto H8SX::Download(const std::vector<uint8_t> &data) const -> void
     CHECK_ERR("error during programming stop!");
 
     // User MAT Sum Check 0x4B ->
-    cmd = static_cast<uint8_t>(H8SXCmd::USER_MAT_CHECKSUM);
+    uint8_t cmd = static_cast<uint8_t>(H8SXCmd::USER_MAT_CHECKSUM);
     err = libusb_bulk_transfer(device, BULK_EP_OUT, &cmd, 1, &transferred, 0);
     CHECK_ERR("error during user MAT sum check!");
     err = libusb_bulk_transfer(device, BULK_EP_IN, buf, sizeof(buf), &received, 0);
@@ -250,14 +272,7 @@ auto H8SX::CheckDevice() const -> void
 
 auto H8SX::Checksum(const uint8_t *data, size_t len) const -> uint8_t
 {
-    uint8_t sum = 0;
-    for (size_t i = 0; i < len; i++)
-    {
-        sum += data[i];
-    }
-    sum = ~sum;
-    sum++;
-    return sum;
+    return static_cast<uint8_t>(checksum::H8SXChecksum().Update(std::span<const uint8_t>(data, len)).Finalize());
 }
 
 auto H8SX::InquireDevice(struct dev_inq_hdr_t **hdr) const -> void
@@ -1,6 +1,7 @@
 #include <radio_tool/hid/hid.hpp>
 
 #include <stdexcept>
+#include <algorithm>
 
 using namespace radio_tool::hid;
 
@@ -22,7 +23,22 @@ auto HID::InterruptRead(const uint8_t &ep, const uint16_t &len) const -> std::ve
     return data;
 }
 
-auto HID::InterruptWrite(const uint8_t &ep, const std::vector<uint8_t> &data) const -> void
+auto HID::Gather(std::span<uint8_t> out, std::initializer_list<std::span<const uint8_t>> parts) -> size_t
+{
+    size_t len = 0;
+    for (const auto &p : parts)
+    {
+        if (p.size() > out.size() - len)
+        {
+            throw std::runtime_error("Transfer too large!");
+        }
+        std::copy(p.begin(), p.end(), out.begin() + len);
+        len += p.size();
+    }
+    return len;
+}
+
+auto HID::InterruptWrite(const uint8_t &ep, std::span<const uint8_t> data) const -> void
 {
     int rlen = 0;
     auto err = libusb_interrupt_transfer(device, ep, (unsigned char *)data.data(), data.size(), &rlen, timeout);
@@ -37,6 +53,13 @@ auto HID::InterruptWrite(const uint8_t &ep, const std::vector<uint8_t> &data) co
     }
 }
 
+auto HID::InterruptWrite(const uint8_t &ep, std::initializer_list<std::span<const uint8_t>> parts) const -> void
+{
+    uint8_t buf[MaxGatherSize];
+    auto len = Gather(buf, parts);
+    InterruptWrite(ep, std::span<const uint8_t>(buf, len));
+}
+
 auto HID::BulkRead(const uint8_t &ep, const uint16_t &len) const -> std::vector<uint8_t>
 {
     std::vector<uint8_t> data(len);
@@ -55,7 +78,7 @@ auto HID::BulkRead(const uint8_t &ep, const uint16_t &len) const -> std::vector<
     return data;
 }
 
-auto HID::BulkWrite(const uint8_t &ep, const std::vector<uint8_t> &data) const -> void
+auto HID::BulkWrite(const uint8_t &ep, std::span<const uint8_t> data) const -> void
 {
     int rlen = 0;
     auto err = libusb_bulk_transfer(device, ep, (unsigned char *)data.data(), data.size(), &rlen, timeout);
@@ -68,4 +91,11 @@ auto HID::BulkWrite(const uint8_t &ep, const std::vector<uint8_t> &data) const -
     {
         throw std::runtime_error("Invalid write len!");
     }
+}
+
+auto HID::BulkWrite(const uint8_t &ep, std::initializer_list<std::span<const uint8_t>> parts) const -> void
+{
+    uint8_t buf[MaxGatherSize];
+    auto len = Gather(buf, parts);
+    BulkWrite(ep, std::span<const uint8_t>(buf, len));
 }
\ No newline at end of file
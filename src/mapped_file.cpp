@@ -0,0 +1,122 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <radio_tool/util/mapped_file.hpp>
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace radio_tool;
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& file)
+	: base(nullptr), size(0), file_handle(INVALID_HANDLE_VALUE), map_handle(nullptr)
+{
+	file_handle = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_handle == INVALID_HANDLE_VALUE)
+	{
+		throw std::runtime_error("Can't open firmware file");
+	}
+
+	LARGE_INTEGER len;
+	if (!GetFileSizeEx(file_handle, &len))
+	{
+		CloseHandle(file_handle);
+		throw std::runtime_error("Can't get file size");
+	}
+	size = static_cast<size_t>(len.QuadPart);
+
+	//zero length files cant be mapped, leave the view empty
+	if (size > 0)
+	{
+		map_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (map_handle == nullptr)
+		{
+			CloseHandle(file_handle);
+			throw std::runtime_error("Can't map firmware file");
+		}
+		base = static_cast<const uint8_t*>(MapViewOfFile(map_handle, FILE_MAP_READ, 0, 0, 0));
+		if (base == nullptr)
+		{
+			CloseHandle(map_handle);
+			CloseHandle(file_handle);
+			throw std::runtime_error("Can't map firmware file");
+		}
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if (base != nullptr)
+	{
+		UnmapViewOfFile(base);
+	}
+	if (map_handle != nullptr)
+	{
+		CloseHandle(map_handle);
+	}
+	CloseHandle(file_handle);
+}
+#else
+MappedFile::MappedFile(const std::string& file)
+	: base(nullptr), size(0), fd(-1)
+{
+	fd = open(file.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		throw std::runtime_error("Can't open firmware file");
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		close(fd);
+		throw std::runtime_error("Can't get file size");
+	}
+	size = static_cast<size_t>(st.st_size);
+
+	//zero length files cant be mapped, leave the view empty
+	if (size > 0)
+	{
+		auto addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr == MAP_FAILED)
+		{
+			close(fd);
+			throw std::runtime_error("Can't map firmware file");
+		}
+		base = static_cast<const uint8_t*>(addr);
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if (base != nullptr)
+	{
+		munmap(const_cast<uint8_t*>(base), size);
+	}
+	close(fd);
+}
+#endif
@@ -20,35 +20,40 @@
 #include <radio_tool/radio/serial_radio_factory.hpp>
 
 #include <functional>
+#include <iterator>
+#include <algorithm>
 
 using namespace radio_tool::radio;
 
-auto RadioFactory::OpenDevice(const uint16_t &index) const -> RadioOperations *
+RadioFactory::RadioFactory()
+    : usb(), serial(), devices()
 {
-    auto devices = ListDevices();
+    Refresh();
+}
 
-    auto info = devices.at(index);
-    if (info == nullptr)
+auto RadioFactory::OpenDevice(const uint16_t &index) const -> RadioHandle
+{
+    if (index >= devices.size())
     {
         throw std::runtime_error("Invalid device index");
     }
 
-    return info->OpenDevice();
+    return devices[index]->OpenDevice();
+}
+
+auto RadioFactory::ListDevices() const -> const std::vector<std::unique_ptr<RadioInfo>> &
+{
+    return devices;
 }
 
-auto RadioFactory::ListDevices() const -> const std::vector<RadioInfo *>
+auto RadioFactory::Refresh() -> void
 {
-    uint16_t idx_offset = 0;
-    auto ret = std::vector<RadioInfo *>();
+    devices.clear();
 
-    auto usb = USBRadioFactory();
-    auto usbDevices = usb.ListDevices(idx_offset);
-    ret.insert(ret.end(), usbDevices.begin(), usbDevices.end());
-    idx_offset += (uint16_t)usbDevices.size();
+    auto usbDevices = usb.ListDevices(0);
+    auto idx_offset = (uint16_t)usbDevices.size();
+    std::move(usbDevices.begin(), usbDevices.end(), std::back_inserter(devices));
 
-    auto serial = SerialRadioFactory();
     auto serialDevices = serial.ListDevices(idx_offset);
-    ret.insert(ret.end(), serialDevices.begin(), serialDevices.end());
-
-    return ret;
+    std::move(serialDevices.begin(), serialDevices.end(), std::back_inserter(devices));
 }
\ No newline at end of file
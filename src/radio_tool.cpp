@@ -16,6 +16,7 @@
  * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
  */
 #include <radio_tool/radio/radio_factory.hpp>
+#include <radio_tool/radio/fleet_flasher.hpp>
 #include <radio_tool/fw/fw_factory.hpp>
 #include <radio_tool/codeplug/codeplug_factory.hpp>
 
@@ -64,12 +65,14 @@ int main(int argc, char **argv)
         options.add_options("General")
             ("h,help", "Show this message", cxxopts::value<std::string>()->implicit_value(""), "<command>")
             ("l,list", "List devices")
-            ("d,device", "Device to use", cxxopts::value<uint16_t>(), "<index>")
+            ("d,device", "Device to use, a list or \"all\" flashes radios concurrently", cxxopts::value<std::string>(), "<index|0,1,..|all>")
             ("i,in", "Input file", cxxopts::value<std::string>(), "<file>")
             ("o,out", "Output file", cxxopts::value<std::string>(), "<file>");
 
         options.add_options("Programming")
             ("f,flash", "Flash firmware")
+            ("diff", "Only flash sectors which differ from the radio (TYT only)")
+            ("port-limit", "Max radios flashed at once behind one USB root port", cxxopts::value<size_t>()->default_value(std::to_string(FleetFlasher::DefaultPortLimit)), "<n>")
             ("p,program", "Upload codeplug");
 
         options.add_options("All radio")
@@ -87,6 +90,7 @@ int main(int argc, char **argv)
             ("fw-info", "Print info about a firmware file")
             ("wrap", "Wrap a firmware bin (use --help wrap, for more info)")
             ("unwrap", "Unwrap a fimrware file")
+            ("parallel", "Encrypt/decrypt firmware using all CPU cores")
 #ifdef XOR_TOOL
             ("make-xor", "Try to make an XOR key for the input firmware");
 #else
@@ -141,6 +145,8 @@ int main(int argc, char **argv)
             auto file = GetOptionOrErr<std::string>(cmd, "in", "Input file not specified");
 
             auto fw = FirmwareFactory::GetFirmwareFileHandler(file);
+            fw->SetReadMode(ReadMode::Mapped);
+            fw->SetExecutionMode(cmd.count("parallel") ? ExecutionMode::Parallel : ExecutionMode::Serial);
             fw->Read(file);
             std::cerr << fw->ToString();
             exit(0);
@@ -164,6 +170,7 @@ int main(int argc, char **argv)
 
             auto fw = FirmwareFactory::GetFirmwareModelHandler(radio);
             fw->SetRadioModel(radio);
+            fw->SetExecutionMode(cmd.count("parallel") ? ExecutionMode::Parallel : ExecutionMode::Serial);
             for (const auto &sx : segments)
             {
                 auto schar = sx.find(':');
@@ -222,6 +229,8 @@ int main(int argc, char **argv)
             auto out_file = GetOptionOrErr<std::string>(cmd, "out", "Output file not specified");
 
             auto fw_handler = FirmwareFactory::GetFirmwareFileHandler(in_file);
+            fw_handler->SetReadMode(ReadMode::Mapped);
+            fw_handler->SetExecutionMode(cmd.count("parallel") ? ExecutionMode::Parallel : ExecutionMode::Serial);
             fw_handler->Read(in_file);
             fw_handler->Decrypt();
 
@@ -256,7 +265,7 @@ int main(int argc, char **argv)
             auto key = radio_tool::fw::XORTool::MakeXOR(fw_handler->GetData());
             for (const auto &region : fw_handler->GetDataSegments())
             {
-                if (radio_tool::fw::XORTool::Verify(region.address, region.data, key))
+                if (radio_tool::fw::XORTool::Verify(region.address, std::vector<uint8_t>(region.data.begin(), region.data.end()), key))
                 {
                     std::cout
                         << "Region @ 0x" << std::setfill('0') << std::setw(8) << std::hex << region.address
@@ -292,7 +301,53 @@ int main(int argc, char **argv)
             exit(1);
         }
 
-        auto index = cmd["device"].as<uint16_t>();
+        auto device = cmd["device"].as<std::string>();
+        if (device == "all" || device.find(',') != std::string::npos)
+        {
+            if (!cmd.count("flash"))
+            {
+                std::cerr << "Multiple devices can only be used with --flash" << std::endl;
+                exit(1);
+            }
+            auto in_file = GetOptionOrErr<std::string>(cmd, "in", "Input file not specified");
+            auto differential = cmd.count("diff") > 0;
+
+            auto indexes = std::vector<uint16_t>();
+            if (device != "all")
+            {
+                std::stringstream ss(device);
+                std::string idx;
+                while (std::getline(ss, idx, ','))
+                {
+                    indexes.push_back(static_cast<uint16_t>(std::stoul(idx)));
+                }
+            }
+
+            auto fleet = FleetFlasher(rdFactory, cmd["port-limit"].as<size_t>());
+            auto results = fleet.Run(indexes, [&in_file, differential](RadioOperations &radio)
+                                     {
+                if (differential)
+                {
+                    auto tyt_radio = dynamic_cast<radio_tool::radio::TYTRadio *>(&radio);
+                    if (tyt_radio == nullptr)
+                    {
+                        throw std::runtime_error("Differential flashing is only supported on TYT radios");
+                    }
+                    tyt_radio->SetDifferential(true);
+                }
+                radio.WriteFirmware(in_file); });
+
+            auto failed = 0;
+            for (const auto &r : results)
+            {
+                std::wcout << r.ToString() << std::endl;
+                failed += r.success ? 0 : 1;
+            }
+            std::wcout << std::dec << (results.size() - failed) << L"/" << results.size() << L" radios flashed" << std::endl;
+            exit(failed == 0 ? 0 : 1);
+        }
+
+        auto index = static_cast<uint16_t>(std::stoul(device));
         auto radio = rdFactory.OpenDevice(index);
 
         if (cmd.count("info"))
@@ -304,6 +359,16 @@ int main(int argc, char **argv)
         if (cmd.count("flash"))
         {
             auto in_file = GetOptionOrErr<std::string>(cmd, "in", "Input file not specified");
+            if (cmd.count("diff"))
+            {
+                auto tyt_radio = dynamic_cast<radio_tool::radio::TYTRadio *>(radio.get());
+                if (tyt_radio == nullptr)
+                {
+                    std::cerr << "Differential flashing is only supported on TYT radios" << std::endl;
+                    exit(1);
+                }
+                tyt_radio->SetDifferential(true);
+            }
             radio->WriteFirmware(in_file);
             std::cout << "Done!" << std::endl;
             exit(0);
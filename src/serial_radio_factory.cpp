@@ -43,9 +43,9 @@ struct DeviceMapper
 const std::vector<DeviceMapper> Drivers = {
 	{AilunceRadio::SupportsDevice, AilunceRadio::Create} };
 
-auto SerialRadioFactory::ListDevices(const uint16_t& idx_offset) const -> const std::vector<RadioInfo*>
+auto SerialRadioFactory::ListDevices(const uint16_t& idx_offset) const -> std::vector<std::unique_ptr<RadioInfo>>
 {
-	auto ret = std::vector<RadioInfo*>();
+	auto ret = std::vector<std::unique_ptr<RadioInfo>>();
 
 	OpDeviceList(
 		[&ret, idx_offset](const std::string& port, const uint16_t& idx)
@@ -54,12 +54,12 @@ auto SerialRadioFactory::ListDevices(const uint16_t& idx_offset) const -> const
 			{
 				auto fnOpen = [&driver, port]()
 				{
-					return driver.CreateOperations(port);
+					return RadioHandle(driver.CreateOperations(port), std::default_delete<RadioOperations>());
 				};
 
 				if (driver.SupportsDevice(port))
 				{
-					ret.push_back(new SerialRadioInfo(fnOpen, port, idx_offset + idx));
+					ret.push_back(std::make_unique<SerialRadioInfo>(fnOpen, port, idx_offset + idx));
 				}
 			}
 		});
@@ -0,0 +1,912 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <radio_tool/util/simd.hpp>
+
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+/**
+ * GCC/Clang need each function marked with the instruction set it uses, MSVC allows any intrinsic
+ */
+#if defined(SIMD_X86) && !defined(_MSC_VER)
+#define SIMD_TARGET(x) __attribute__((target(x)))
+#else
+#define SIMD_TARGET(x)
+#endif
+
+using namespace radio_tool;
+
+/**
+ * Kernels for one instruction set
+ */
+class SimdKernels
+{
+public:
+	void (*xor_bytes)(uint8_t* dst, const uint8_t* src, size_t len);
+	void (*sgl_decrypt)(uint8_t* dst, const uint8_t* key, size_t len);
+	void (*sgl_encrypt)(uint8_t* dst, const uint8_t* key, size_t len);
+	void (*ailunce_words)(uint8_t* dst, size_t words);
+	uint64_t (*byte_sum)(const uint8_t* src, size_t len);
+	void (*fletcher16)(uint32_t& c0, uint32_t& c1, const uint8_t* src, size_t len);
+	uint64_t (*word_sum_be)(const uint8_t* src, size_t len);
+	uint64_t (*xor_byte_sum)(const uint8_t* src, const uint8_t* key, size_t len);
+};
+
+/**
+ * Bytes summed between each mod 255 in the Fletcher kernels, small enough that no
+ * lane overflows and a multiple of every vector width
+ */
+constexpr size_t FletcherBlock = 4096;
+
+static auto XORBytesScalar(uint8_t* dst, const uint8_t* src, size_t len) -> void
+{
+	for (; len >= sizeof(uint64_t); dst += sizeof(uint64_t), src += sizeof(uint64_t), len -= sizeof(uint64_t))
+	{
+		uint64_t a, b;
+		memcpy(&a, dst, sizeof(a));
+		memcpy(&b, src, sizeof(b));
+		a ^= b;
+		memcpy(dst, &a, sizeof(a));
+	}
+	for (; len > 0; dst++, src++, len--)
+	{
+		*dst ^= *src;
+	}
+}
+
+/**
+ * Rotate each byte of a word, using shifts on the whole word and masking off
+ * the bits which crossed into the next byte
+ */
+static inline auto Rotl3Bytes(const uint64_t& x) -> uint64_t
+{
+	return ((x << 3) & 0xf8f8f8f8f8f8f8f8ULL) | ((x >> 5) & 0x0707070707070707ULL);
+}
+
+static inline auto Rotr3Bytes(const uint64_t& x) -> uint64_t
+{
+	return ((x >> 3) & 0x1f1f1f1f1f1f1f1fULL) | ((x << 5) & 0xe0e0e0e0e0e0e0e0ULL);
+}
+
+static auto SGLDecryptScalar(uint8_t* dst, const uint8_t* key, size_t len) -> void
+{
+	for (; len >= sizeof(uint64_t); dst += sizeof(uint64_t), key += sizeof(uint64_t), len -= sizeof(uint64_t))
+	{
+		uint64_t x, k;
+		memcpy(&x, dst, sizeof(x));
+		memcpy(&k, key, sizeof(k));
+		x = ~Rotl3Bytes(x) ^ k;
+		memcpy(dst, &x, sizeof(x));
+	}
+	for (; len > 0; dst++, key++, len--)
+	{
+		*dst = ~(((*dst << 3) & 0b11111000) | ((*dst >> 5) & 0b00000111)) ^ *key;
+	}
+}
+
+static auto SGLEncryptScalar(uint8_t* dst, const uint8_t* key, size_t len) -> void
+{
+	for (; len >= sizeof(uint64_t); dst += sizeof(uint64_t), key += sizeof(uint64_t), len -= sizeof(uint64_t))
+	{
+		uint64_t x, k;
+		memcpy(&x, dst, sizeof(x));
+		memcpy(&k, key, sizeof(k));
+		x = ~Rotr3Bytes(x ^ k);
+		memcpy(dst, &x, sizeof(x));
+	}
+	for (; len > 0; dst++, key++, len--)
+	{
+		uint8_t x = *dst ^ *key;
+		*dst = ~(((x >> 3) & 0b00011111) | ((x << 5) & 0b11100000));
+	}
+}
+
+/**
+ * The Ailunce kernels build the mask from compares instead of branching,
+ * 0x07777777 ^ 0x06666666 = 0x01111111 selects the bit 28 mask
+ */
+static auto AilunceWordsScalar(uint8_t* dst, size_t words) -> void
+{
+	for (; words > 0; dst += sizeof(uint32_t), words--)
+	{
+		uint32_t w;
+		memcpy(&w, dst, sizeof(w));
+		auto m = 0x07777777u ^ (((w >> 28) & 1u) * 0x06666666u);
+		m |= 0u - static_cast<uint32_t>(w == 0 || w == 0xffffffff);
+		w ^= m;
+		memcpy(dst, &w, sizeof(w));
+	}
+}
+
+/**
+ * Sum bytes into 16-bit lanes of a word, each lane takes at most 2 * 255 per word so
+ * the lanes are folded into the total every 128 words before they can overflow
+ */
+static auto ByteSumScalar(const uint8_t* src, size_t len) -> uint64_t
+{
+	constexpr auto Even = 0x00ff00ff00ff00ffULL;
+	uint64_t sum = 0;
+	while (len >= sizeof(uint64_t))
+	{
+		uint64_t lanes = 0;
+		for (auto n = 0; n < 128 && len >= sizeof(uint64_t); n++, src += sizeof(uint64_t), len -= sizeof(uint64_t))
+		{
+			uint64_t x;
+			memcpy(&x, src, sizeof(x));
+			lanes += (x & Even) + ((x >> 8) & Even);
+		}
+		sum += (lanes & 0xffff) + ((lanes >> 16) & 0xffff) + ((lanes >> 32) & 0xffff) + (lanes >> 48);
+	}
+	for (; len > 0; src++, len--)
+	{
+		sum += *src;
+	}
+	return sum;
+}
+
+static auto Fletcher16Scalar(uint32_t& c0, uint32_t& c1, const uint8_t* src, size_t len) -> void
+{
+	while (len > 0)
+	{
+		auto n = std::min(len, FletcherBlock);
+		for (auto end = src + n; src != end; src++)
+		{
+			c0 += *src;
+			c1 += c0;
+		}
+		c0 %= 255;
+		c1 %= 255;
+		len -= n;
+	}
+}
+
+static auto XORByteSumScalar(const uint8_t* src, const uint8_t* key, size_t len) -> uint64_t
+{
+	constexpr auto Even = 0x00ff00ff00ff00ffULL;
+	uint64_t sum = 0;
+	while (len >= sizeof(uint64_t))
+	{
+		uint64_t lanes = 0;
+		for (auto n = 0; n < 128 && len >= sizeof(uint64_t); n++, src += sizeof(uint64_t), key += sizeof(uint64_t), len -= sizeof(uint64_t))
+		{
+			uint64_t x, k;
+			memcpy(&x, src, sizeof(x));
+			memcpy(&k, key, sizeof(k));
+			x ^= k;
+			lanes += (x & Even) + ((x >> 8) & Even);
+		}
+		sum += (lanes & 0xffff) + ((lanes >> 16) & 0xffff) + ((lanes >> 32) & 0xffff) + (lanes >> 48);
+	}
+	for (; len > 0; src++, key++, len--)
+	{
+		sum += *src ^ *key;
+	}
+	return sum;
+}
+
+/**
+ * Big endian words are (even byte << 8) + odd byte, so the even and odd bytes are
+ * summed separately in the same 16-bit lanes as ByteSumScalar
+ */
+static auto WordSumBEScalar(const uint8_t* src, size_t len) -> uint64_t
+{
+	constexpr auto Even = 0x00ff00ff00ff00ffULL;
+	auto fold = [](const uint64_t& lanes) {
+		return (lanes & 0xffff) + ((lanes >> 16) & 0xffff) + ((lanes >> 32) & 0xffff) + (lanes >> 48);
+	};
+	uint64_t even = 0, odd = 0;
+	while (len >= sizeof(uint64_t))
+	{
+		uint64_t even_lanes = 0, odd_lanes = 0;
+		for (auto n = 0; n < 256 && len >= sizeof(uint64_t); n++, src += sizeof(uint64_t), len -= sizeof(uint64_t))
+		{
+			uint64_t x;
+			memcpy(&x, src, sizeof(x));
+			if constexpr (std::endian::native == std::endian::little)
+			{
+				even_lanes += x & Even;
+				odd_lanes += (x >> 8) & Even;
+			}
+			else
+			{
+				even_lanes += (x >> 8) & Even;
+				odd_lanes += x & Even;
+			}
+		}
+		even += fold(even_lanes);
+		odd += fold(odd_lanes);
+	}
+	for (; len > 1; src += 2, len -= 2)
+	{
+		even += src[0];
+		odd += src[1];
+	}
+	if (len > 0)
+	{
+		even += src[0];
+	}
+	return (even << 8) + odd;
+}
+
+/**
+ * Fold the lane sums of k vectors of Width bytes into c0/c1, each byte adds its value
+ * times the number of bytes after it (inclusive) to c1:
+ *   c1 += k * Width * c0 + Width * prefix + weighted
+ *   c0 += sum
+ */
+static inline auto FletcherFold(uint32_t& c0, uint32_t& c1, const size_t& bytes, const size_t& width,
+	const uint64_t& sum, const uint64_t& prefix, const uint64_t& weighted) -> void
+{
+	c1 = static_cast<uint32_t>((c1 + bytes * c0 + width * prefix + weighted) % 255);
+	c0 = static_cast<uint32_t>((c0 + sum) % 255);
+}
+
+#ifdef SIMD_X86
+SIMD_TARGET("sse2")
+static auto XORBytesSSE2(uint8_t* dst, const uint8_t* src, size_t len) -> void
+{
+	for (; len >= 16; dst += 16, src += 16, len -= 16)
+	{
+		auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst));
+		auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_xor_si128(a, b));
+	}
+	XORBytesScalar(dst, src, len);
+}
+
+SIMD_TARGET("avx2")
+static auto XORBytesAVX2(uint8_t* dst, const uint8_t* src, size_t len) -> void
+{
+	for (; len >= 64; dst += 64, src += 64, len -= 64)
+	{
+		auto a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst));
+		auto a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + 32));
+		auto b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+		auto b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_xor_si256(a0, b0));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), _mm256_xor_si256(a1, b1));
+	}
+	XORBytesSSE2(dst, src, len);
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static auto XORBytesAVX512(uint8_t* dst, const uint8_t* src, size_t len) -> void
+{
+	for (; len >= 64; dst += 64, src += 64, len -= 64)
+	{
+		auto a = _mm512_loadu_si512(dst);
+		auto b = _mm512_loadu_si512(src);
+		_mm512_storeu_si512(dst, _mm512_xor_si512(a, b));
+	}
+	if (len > 0)
+	{
+		//tail in one masked operation
+		auto mask = static_cast<__mmask64>((1ULL << len) - 1);
+		auto a = _mm512_maskz_loadu_epi8(mask, dst);
+		auto b = _mm512_maskz_loadu_epi8(mask, src);
+		_mm512_mask_storeu_epi8(dst, mask, _mm512_xor_si512(a, b));
+	}
+}
+
+/**
+ * SGL kernels rotate bytes with 16-bit shifts, the same masks as Rotl3Bytes/Rotr3Bytes
+ */
+SIMD_TARGET("sse2")
+static auto SGLDecryptSSE2(uint8_t* dst, const uint8_t* key, size_t len) -> void
+{
+	const auto hi = _mm_set1_epi8((char)0xf8), lo = _mm_set1_epi8(0x07), ones = _mm_set1_epi8((char)0xff);
+	for (; len >= 16; dst += 16, key += 16, len -= 16)
+	{
+		auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst));
+		auto k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+		auto r = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(x, 3), hi), _mm_and_si128(_mm_srli_epi16(x, 5), lo));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_xor_si128(_mm_xor_si128(r, ones), k));
+	}
+	SGLDecryptScalar(dst, key, len);
+}
+
+SIMD_TARGET("sse2")
+static auto SGLEncryptSSE2(uint8_t* dst, const uint8_t* key, size_t len) -> void
+{
+	const auto lo = _mm_set1_epi8(0x1f), hi = _mm_set1_epi8((char)0xe0), ones = _mm_set1_epi8((char)0xff);
+	for (; len >= 16; dst += 16, key += 16, len -= 16)
+	{
+		auto x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(dst)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(key)));
+		auto r = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(x, 3), lo), _mm_and_si128(_mm_slli_epi16(x, 5), hi));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_xor_si128(r, ones));
+	}
+	SGLEncryptScalar(dst, key, len);
+}
+
+SIMD_TARGET("avx2")
+static auto SGLDecryptAVX2(uint8_t* dst, const uint8_t* key, size_t len) -> void
+{
+	const auto hi = _mm256_set1_epi8((char)0xf8), lo = _mm256_set1_epi8(0x07), ones = _mm256_set1_epi8((char)0xff);
+	for (; len >= 32; dst += 32, key += 32, len -= 32)
+	{
+		auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst));
+		auto k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key));
+		auto r = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(x, 3), hi), _mm256_and_si256(_mm256_srli_epi16(x, 5), lo));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_xor_si256(_mm256_xor_si256(r, ones), k));
+	}
+	SGLDecryptSSE2(dst, key, len);
+}
+
+SIMD_TARGET("avx2")
+static auto SGLEncryptAVX2(uint8_t* dst, const uint8_t* key, size_t len) -> void
+{
+	const auto lo = _mm256_set1_epi8(0x1f), hi = _mm256_set1_epi8((char)0xe0), ones = _mm256_set1_epi8((char)0xff);
+	for (; len >= 32; dst += 32, key += 32, len -= 32)
+	{
+		auto x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key)));
+		auto r = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(x, 3), lo), _mm256_and_si256(_mm256_slli_epi16(x, 5), hi));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_xor_si256(r, ones));
+	}
+	SGLEncryptSSE2(dst, key, len);
+}
+
+/**
+ * Ternary logic selects the rotated bits in one op, imm 0xca is (A & B) | (~A & C)
+ */
+SIMD_TARGET("avx512f,avx512bw")
+static auto SGLDecryptAVX512(uint8_t* dst, const uint8_t* key, size_t len) -> void
+{
+	const auto hi = _mm512_set1_epi8((char)0xf8);
+	while (len > 0)
+	{
+		auto n = std::min<size_t>(len, 64);
+		auto mask = n == 64 ? ~__mmask64(0) : static_cast<__mmask64>((1ULL << n) - 1);
+		auto x = _mm512_maskz_loadu_epi8(mask, dst);
+		auto k = _mm512_maskz_loadu_epi8(mask, key);
+		auto r = _mm512_ternarylogic_epi64(hi, _mm512_slli_epi16(x, 3), _mm512_srli_epi16(x, 5), 0xca);
+		//~A ^ B
+		_mm512_mask_storeu_epi8(dst, mask, _mm512_ternarylogic_epi64(r, k, k, 0xc3));
+		dst += n;
+		key += n;
+		len -= n;
+	}
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static auto SGLEncryptAVX512(uint8_t* dst, const uint8_t* key, size_t len) -> void
+{
+	const auto lo = _mm512_set1_epi8(0x1f);
+	while (len > 0)
+	{
+		auto n = std::min<size_t>(len, 64);
+		auto mask = n == 64 ? ~__mmask64(0) : static_cast<__mmask64>((1ULL << n) - 1);
+		auto x = _mm512_xor_si512(_mm512_maskz_loadu_epi8(mask, dst), _mm512_maskz_loadu_epi8(mask, key));
+		//~((A & B) | (~A & C))
+		auto r = _mm512_ternarylogic_epi64(lo, _mm512_srli_epi16(x, 3), _mm512_slli_epi16(x, 5), 0x35);
+		_mm512_mask_storeu_epi8(dst, mask, r);
+		dst += n;
+		key += n;
+		len -= n;
+	}
+}
+
+SIMD_TARGET("sse2")
+static auto AilunceWordsSSE2(uint8_t* dst, size_t words) -> void
+{
+	const auto zero = _mm_setzero_si128(), ones = _mm_set1_epi32(-1);
+	const auto bit28 = _mm_set1_epi32(1 << 28), base = _mm_set1_epi32(0x07777777), sel = _mm_set1_epi32(0x06666666);
+	for (; words >= 4; dst += 16, words -= 4)
+	{
+		auto w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst));
+		auto special = _mm_or_si128(_mm_cmpeq_epi32(w, zero), _mm_cmpeq_epi32(w, ones));
+		auto has28 = _mm_cmpeq_epi32(_mm_and_si128(w, bit28), bit28);
+		auto m = _mm_or_si128(_mm_xor_si128(base, _mm_and_si128(has28, sel)), special);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_xor_si128(w, m));
+	}
+	AilunceWordsScalar(dst, words);
+}
+
+SIMD_TARGET("avx2")
+static auto AilunceWordsAVX2(uint8_t* dst, size_t words) -> void
+{
+	const auto zero = _mm256_setzero_si256(), ones = _mm256_set1_epi32(-1);
+	const auto bit28 = _mm256_set1_epi32(1 << 28), base = _mm256_set1_epi32(0x07777777), sel = _mm256_set1_epi32(0x06666666);
+	for (; words >= 8; dst += 32, words -= 8)
+	{
+		auto w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst));
+		auto special = _mm256_or_si256(_mm256_cmpeq_epi32(w, zero), _mm256_cmpeq_epi32(w, ones));
+		auto has28 = _mm256_cmpeq_epi32(_mm256_and_si256(w, bit28), bit28);
+		auto m = _mm256_or_si256(_mm256_xor_si256(base, _mm256_and_si256(has28, sel)), special);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_xor_si256(w, m));
+	}
+	AilunceWordsSSE2(dst, words);
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static auto AilunceWordsAVX512(uint8_t* dst, size_t words) -> void
+{
+	const auto ones = _mm512_set1_epi32(-1), bit28 = _mm512_set1_epi32(1 << 28);
+	const auto normal = _mm512_set1_epi32(0x07777777), set28 = _mm512_set1_epi32(0x01111111);
+	while (words > 0)
+	{
+		auto n = std::min<size_t>(words, 16);
+		auto lanes = static_cast<__mmask16>((1u << n) - 1);
+		auto w = _mm512_maskz_loadu_epi32(lanes, dst);
+		auto m = _mm512_mask_blend_epi32(_mm512_test_epi32_mask(w, bit28), normal, set28);
+		auto special = _mm512_cmpeq_epi32_mask(w, _mm512_setzero_si512()) | _mm512_cmpeq_epi32_mask(w, ones);
+		m = _mm512_mask_blend_epi32(special, m, ones);
+		_mm512_mask_storeu_epi32(dst, lanes, _mm512_xor_si512(w, m));
+		dst += n * sizeof(uint32_t);
+		words -= n;
+	}
+}
+
+/**
+ * psadbw against zero sums each group of 8 bytes into a 64-bit lane
+ */
+SIMD_TARGET("sse2")
+static auto ByteSumSSE2(const uint8_t* src, size_t len) -> uint64_t
+{
+	const auto zero = _mm_setzero_si128();
+	auto acc = _mm_setzero_si128();
+	for (; len >= 16; src += 16, len -= 16)
+	{
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), zero));
+	}
+	uint64_t lanes[2];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+	return lanes[0] + lanes[1] + ByteSumScalar(src, len);
+}
+
+SIMD_TARGET("avx2")
+static auto ByteSumAVX2(const uint8_t* src, size_t len) -> uint64_t
+{
+	const auto zero = _mm256_setzero_si256();
+	auto acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+	for (; len >= 64; src += 64, len -= 64)
+	{
+		acc0 = _mm256_add_epi64(acc0, _mm256_sad_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), zero));
+		acc1 = _mm256_add_epi64(acc1, _mm256_sad_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32)), zero));
+	}
+	uint64_t lanes[4];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(acc0, acc1));
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + ByteSumSSE2(src, len);
+}
+
+/**
+ * Add the 8 64-bit lanes
+ *
+ * Done by hand with zero masked extracts since _mm512_reduce_add_epi64 and the unmasked extracts
+ * start from _mm256_undefined_si256, which GCC 12 reports with -Wuninitialized
+ */
+SIMD_TARGET("avx512f")
+static inline auto HSum64(const __m512i& v) -> uint64_t
+{
+	auto quad = _mm256_add_epi64(_mm512_maskz_extracti64x4_epi64(0xff, v, 0), _mm512_maskz_extracti64x4_epi64(0xff, v, 1));
+	auto pair = _mm_add_epi64(_mm256_castsi256_si128(quad), _mm256_extracti128_si256(quad, 1));
+	return static_cast<uint64_t>(_mm_cvtsi128_si64(pair)) + static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(pair, pair)));
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static auto ByteSumAVX512(const uint8_t* src, size_t len) -> uint64_t
+{
+	const auto zero = _mm512_setzero_si512();
+	auto acc = _mm512_setzero_si512();
+	for (; len >= 64; src += 64, len -= 64)
+	{
+		acc = _mm512_add_epi64(acc, _mm512_sad_epu8(_mm512_loadu_si512(src), zero));
+	}
+	if (len > 0)
+	{
+		auto mask = static_cast<__mmask64>((1ULL << len) - 1);
+		acc = _mm512_add_epi64(acc, _mm512_sad_epu8(_mm512_maskz_loadu_epi8(mask, src), zero));
+	}
+	return HSum64(acc);
+}
+
+SIMD_TARGET("sse2")
+static inline auto HSum32(const __m128i& v) -> uint64_t
+{
+	uint32_t lanes[4];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), v);
+	return static_cast<uint64_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+}
+
+/**
+ * SSE2 has no unsigned byte multiply so the bytes are widened to 16-bit for pmaddwd
+ */
+SIMD_TARGET("sse2")
+static auto Fletcher16SSE2(uint32_t& c0, uint32_t& c1, const uint8_t* src, size_t len) -> void
+{
+	const auto zero = _mm_setzero_si128();
+	const auto w_lo = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9), w_hi = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+	while (len >= 16)
+	{
+		auto n = std::min(len, FletcherBlock) & ~size_t(15);
+		auto sum = _mm_setzero_si128(), prefix = _mm_setzero_si128(), weighted = _mm_setzero_si128();
+		for (auto end = src + n; src != end; src += 16)
+		{
+			auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+			prefix = _mm_add_epi32(prefix, sum);
+			sum = _mm_add_epi32(sum, _mm_sad_epu8(x, zero));
+			weighted = _mm_add_epi32(weighted, _mm_madd_epi16(_mm_unpacklo_epi8(x, zero), w_lo));
+			weighted = _mm_add_epi32(weighted, _mm_madd_epi16(_mm_unpackhi_epi8(x, zero), w_hi));
+		}
+		FletcherFold(c0, c1, n, 16, HSum32(sum), HSum32(prefix), HSum32(weighted));
+		len -= n;
+	}
+	Fletcher16Scalar(c0, c1, src, len);
+}
+
+SIMD_TARGET("avx2")
+static inline auto HSum32(const __m256i& v) -> uint64_t
+{
+	return HSum32(_mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+}
+
+SIMD_TARGET("avx2")
+static auto Fletcher16AVX2(uint32_t& c0, uint32_t& c1, const uint8_t* src, size_t len) -> void
+{
+	const auto zero = _mm256_setzero_si256(), ones = _mm256_set1_epi16(1);
+	const auto weights = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+		16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+	while (len >= 32)
+	{
+		auto n = std::min(len, FletcherBlock) & ~size_t(31);
+		auto sum = _mm256_setzero_si256(), prefix = _mm256_setzero_si256(), weighted = _mm256_setzero_si256();
+		for (auto end = src + n; src != end; src += 32)
+		{
+			auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+			prefix = _mm256_add_epi32(prefix, sum);
+			sum = _mm256_add_epi32(sum, _mm256_sad_epu8(x, zero));
+			weighted = _mm256_add_epi32(weighted, _mm256_madd_epi16(_mm256_maddubs_epi16(x, weights), ones));
+		}
+		FletcherFold(c0, c1, n, 32, HSum32(sum), HSum32(prefix), HSum32(weighted));
+		len -= n;
+	}
+	Fletcher16SSE2(c0, c1, src, len);
+}
+
+/**
+ * Zero masked extracts for the same reason as HSum64
+ */
+SIMD_TARGET("avx512f")
+static inline auto HSum32(const __m512i& v) -> uint64_t
+{
+	return HSum32(_mm256_add_epi32(_mm512_maskz_extracti64x4_epi64(0xff, v, 0), _mm512_maskz_extracti64x4_epi64(0xff, v, 1)));
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static auto Fletcher16AVX512(uint32_t& c0, uint32_t& c1, const uint8_t* src, size_t len) -> void
+{
+	const auto zero = _mm512_setzero_si512(), ones = _mm512_set1_epi16(1);
+	alignas(64) int8_t w[64];
+	for (auto x = 0; x < 64; x++)
+	{
+		w[x] = static_cast<int8_t>(64 - x);
+	}
+	const auto weights = _mm512_load_si512(w);
+	while (len >= 64)
+	{
+		auto n = std::min(len, FletcherBlock) & ~size_t(63);
+		auto sum = _mm512_setzero_si512(), prefix = _mm512_setzero_si512(), weighted = _mm512_setzero_si512();
+		for (auto end = src + n; src != end; src += 64)
+		{
+			auto x = _mm512_loadu_si512(src);
+			prefix = _mm512_add_epi32(prefix, sum);
+			sum = _mm512_add_epi32(sum, _mm512_sad_epu8(x, zero));
+			weighted = _mm512_add_epi32(weighted, _mm512_madd_epi16(_mm512_maddubs_epi16(x, weights), ones));
+		}
+		FletcherFold(c0, c1, n, 64, HSum32(sum), HSum32(prefix), HSum32(weighted));
+		len -= n;
+	}
+	Fletcher16SSE2(c0, c1, src, len);
+}
+
+/**
+ * Sum of src ^ key without writing anything, for checksums over data which is stored encrypted
+ */
+SIMD_TARGET("sse2")
+static auto XORByteSumSSE2(const uint8_t* src, const uint8_t* key, size_t len) -> uint64_t
+{
+	const auto zero = _mm_setzero_si128();
+	auto acc = _mm_setzero_si128();
+	for (; len >= 16; src += 16, key += 16, len -= 16)
+	{
+		auto x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(key)));
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(x, zero));
+	}
+	uint64_t lanes[2];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+	return lanes[0] + lanes[1] + XORByteSumScalar(src, key, len);
+}
+
+SIMD_TARGET("avx2")
+static auto XORByteSumAVX2(const uint8_t* src, const uint8_t* key, size_t len) -> uint64_t
+{
+	const auto zero = _mm256_setzero_si256();
+	auto acc = _mm256_setzero_si256();
+	for (; len >= 32; src += 32, key += 32, len -= 32)
+	{
+		auto x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key)));
+		acc = _mm256_add_epi64(acc, _mm256_sad_epu8(x, zero));
+	}
+	uint64_t lanes[4];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + XORByteSumSSE2(src, key, len);
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static auto XORByteSumAVX512(const uint8_t* src, const uint8_t* key, size_t len) -> uint64_t
+{
+	const auto zero = _mm512_setzero_si512();
+	auto acc = _mm512_setzero_si512();
+	while (len > 0)
+	{
+		auto n = std::min<size_t>(len, 64);
+		auto mask = n == 64 ? ~__mmask64(0) : static_cast<__mmask64>((1ULL << n) - 1);
+		auto x = _mm512_xor_si512(_mm512_maskz_loadu_epi8(mask, src), _mm512_maskz_loadu_epi8(mask, key));
+		acc = _mm512_add_epi64(acc, _mm512_sad_epu8(x, zero));
+		src += n;
+		key += n;
+		len -= n;
+	}
+	return HSum64(acc);
+}
+
+/**
+ * psadbw on the whole vector and on the even bytes only, the odd bytes are the difference
+ */
+SIMD_TARGET("sse2")
+static auto WordSumBESSE2(const uint8_t* src, size_t len) -> uint64_t
+{
+	const auto zero = _mm_setzero_si128(), even_mask = _mm_set1_epi16(0x00ff);
+	auto all = _mm_setzero_si128(), even = _mm_setzero_si128();
+	for (; len >= 16; src += 16, len -= 16)
+	{
+		auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		all = _mm_add_epi64(all, _mm_sad_epu8(x, zero));
+		even = _mm_add_epi64(even, _mm_sad_epu8(_mm_and_si128(x, even_mask), zero));
+	}
+	uint64_t a[2], e[2];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(a), all);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(e), even);
+	auto even_sum = e[0] + e[1];
+	auto odd_sum = a[0] + a[1] - even_sum;
+	return (even_sum << 8) + odd_sum + WordSumBEScalar(src, len);
+}
+
+SIMD_TARGET("avx2")
+static auto WordSumBEAVX2(const uint8_t* src, size_t len) -> uint64_t
+{
+	const auto zero = _mm256_setzero_si256(), even_mask = _mm256_set1_epi16(0x00ff);
+	auto all = _mm256_setzero_si256(), even = _mm256_setzero_si256();
+	for (; len >= 32; src += 32, len -= 32)
+	{
+		auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+		all = _mm256_add_epi64(all, _mm256_sad_epu8(x, zero));
+		even = _mm256_add_epi64(even, _mm256_sad_epu8(_mm256_and_si256(x, even_mask), zero));
+	}
+	uint64_t a[4], e[4];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(a), all);
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(e), even);
+	auto even_sum = e[0] + e[1] + e[2] + e[3];
+	auto odd_sum = a[0] + a[1] + a[2] + a[3] - even_sum;
+	return (even_sum << 8) + odd_sum + WordSumBESSE2(src, len);
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static auto WordSumBEAVX512(const uint8_t* src, size_t len) -> uint64_t
+{
+	const auto zero = _mm512_setzero_si512(), even_mask = _mm512_set1_epi16(0x00ff);
+	auto all = _mm512_setzero_si512(), even = _mm512_setzero_si512();
+	while (len > 0)
+	{
+		auto n = std::min<size_t>(len, 64);
+		auto mask = n == 64 ? ~__mmask64(0) : static_cast<__mmask64>((1ULL << n) - 1);
+		auto x = _mm512_maskz_loadu_epi8(mask, src);
+		all = _mm512_add_epi64(all, _mm512_sad_epu8(x, zero));
+		even = _mm512_add_epi64(even, _mm512_sad_epu8(_mm512_and_si512(x, even_mask), zero));
+		src += n;
+		len -= n;
+	}
+	auto even_sum = HSum64(even);
+	auto odd_sum = HSum64(all) - even_sum;
+	return (even_sum << 8) + odd_sum;
+}
+#endif
+
+static const SimdKernels Kernels[] = {
+	{ XORBytesScalar, SGLDecryptScalar, SGLEncryptScalar, AilunceWordsScalar, ByteSumScalar, Fletcher16Scalar, WordSumBEScalar, XORByteSumScalar },
+#ifdef SIMD_X86
+	{ XORBytesSSE2, SGLDecryptSSE2, SGLEncryptSSE2, AilunceWordsSSE2, ByteSumSSE2, Fletcher16SSE2, WordSumBESSE2, XORByteSumSSE2 },
+	{ XORBytesAVX2, SGLDecryptAVX2, SGLEncryptAVX2, AilunceWordsAVX2, ByteSumAVX2, Fletcher16AVX2, WordSumBEAVX2, XORByteSumAVX2 },
+	{ XORBytesAVX512, SGLDecryptAVX512, SGLEncryptAVX512, AilunceWordsAVX512, ByteSumAVX512, Fletcher16AVX512, WordSumBEAVX512, XORByteSumAVX512 },
+#endif
+};
+
+#ifdef SIMD_X86
+static auto CpuId(const int& leaf, const int& subleaf, int out[4]) -> void
+{
+#ifdef _MSC_VER
+	__cpuidex(out, leaf, subleaf);
+#else
+	unsigned a, b, c, d;
+	__asm__ __volatile__("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(leaf), "c"(subleaf));
+	out[0] = a;
+	out[1] = b;
+	out[2] = c;
+	out[3] = d;
+#endif
+}
+
+/**
+ * Register state the OS saves on context switch (XCR0)
+ */
+static auto OSSavedState() -> uint64_t
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	unsigned lo, hi;
+	__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+}
+#endif
+
+auto radio_tool::DetectSimdLevel() -> SimdLevel
+{
+	static const auto detected = []() {
+#ifdef SIMD_X86
+		int r[4];
+		CpuId(0, 0, r);
+		const auto max_leaf = r[0];
+
+		CpuId(1, 0, r);
+		if ((r[3] & (1 << 26)) == 0)
+		{
+			return SimdLevel::Scalar;
+		}
+
+		//AVX needs OSXSAVE and the OS saving XMM+YMM
+		const auto osxsave = (r[2] & (1 << 27)) != 0;
+		const auto xcr0 = osxsave ? OSSavedState() : 0;
+		if (max_leaf < 7 || (xcr0 & 0x6) != 0x6)
+		{
+			return SimdLevel::SSE2;
+		}
+
+		CpuId(7, 0, r);
+		const auto avx2 = (r[1] & (1 << 5)) != 0;
+		const auto avx512 = (r[1] & (1 << 16)) != 0 && (r[1] & (1 << 30)) != 0;
+		if (avx512 && (xcr0 & 0xe6) == 0xe6)
+		{
+			return SimdLevel::AVX512;
+		}
+		return avx2 ? SimdLevel::AVX2 : SimdLevel::SSE2;
+#else
+		return SimdLevel::Scalar;
+#endif
+	}();
+	return detected;
+}
+
+static auto CurrentLevel() -> std::atomic<SimdLevel>&
+{
+	static std::atomic<SimdLevel> level(DetectSimdLevel());
+	return level;
+}
+
+auto radio_tool::GetSimdLevel() -> SimdLevel
+{
+	return CurrentLevel().load(std::memory_order_relaxed);
+}
+
+auto radio_tool::SetSimdLevel(const SimdLevel& level) -> void
+{
+	CurrentLevel().store(std::min(level, DetectSimdLevel()), std::memory_order_relaxed);
+}
+
+static auto Current() -> const SimdKernels&
+{
+	return Kernels[static_cast<uint8_t>(GetSimdLevel())];
+}
+
+auto radio_tool::XORBytes(uint8_t* dst, const uint8_t* src, const size_t& len) -> void
+{
+	Current().xor_bytes(dst, src, len);
+}
+
+/**
+ * Apply a kernel over a buffer in runs from the current key position to the end of the key
+ */
+static auto KeyRuns(void (*kernel)(uint8_t*, const uint8_t*, size_t), std::span<uint8_t> data,
+	const uint8_t* key, const uint32_t& key_len, const uint64_t& xor_offset) -> void
+{
+	auto k = static_cast<uint32_t>((key_len & (key_len - 1)) == 0 ? xor_offset & (key_len - 1) : xor_offset % key_len);
+	auto p = data.data();
+	auto n = data.size();
+
+	while (n > 0)
+	{
+		auto run = std::min<size_t>(n, key_len - k);
+		kernel(p, key + k, run);
+		p += run;
+		n -= run;
+		k = 0;
+	}
+}
+
+auto radio_tool::XORKeystream(std::span<uint8_t> data, const uint8_t* key, const uint32_t& key_len, const uint64_t& xor_offset) -> void
+{
+	KeyRuns(Current().xor_bytes, data, key, key_len, xor_offset);
+}
+
+auto radio_tool::SGLDecrypt(std::span<uint8_t> data, const uint8_t* key, const uint32_t& key_len, const uint64_t& xor_offset) -> void
+{
+	KeyRuns(Current().sgl_decrypt, data, key, key_len, xor_offset);
+}
+
+auto radio_tool::SGLEncrypt(std::span<uint8_t> data, const uint8_t* key, const uint32_t& key_len, const uint64_t& xor_offset) -> void
+{
+	KeyRuns(Current().sgl_encrypt, data, key, key_len, xor_offset);
+}
+
+auto radio_tool::AilunceWords(std::span<uint8_t> data) -> void
+{
+	Current().ailunce_words(data.data(), data.size() / sizeof(uint32_t));
+}
+
+auto radio_tool::ByteSum(std::span<const uint8_t> data) -> uint64_t
+{
+	return Current().byte_sum(data.data(), data.size());
+}
+
+auto radio_tool::Fletcher16Update(uint32_t& c0, uint32_t& c1, std::span<const uint8_t> data) -> void
+{
+	Current().fletcher16(c0, c1, data.data(), data.size());
+}
+
+auto radio_tool::WordSumBE(std::span<const uint8_t> data) -> uint64_t
+{
+	return Current().word_sum_be(data.data(), data.size());
+}
+
+auto radio_tool::XORKeystreamSum(std::span<const uint8_t> data, const uint8_t* key, const uint32_t& key_len, const uint64_t& xor_offset) -> uint64_t
+{
+	auto k = static_cast<uint32_t>(xor_offset % key_len);
+	auto p = data.data();
+	auto n = data.size();
+	auto kernel = Current().xor_byte_sum;
+
+	uint64_t sum = 0;
+	while (n > 0)
+	{
+		auto run = std::min<size_t>(n, key_len - k);
+		sum += kernel(p, key + k, run);
+		p += run;
+		n -= run;
+		k = 0;
+	}
+	return sum;
+}
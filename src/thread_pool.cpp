@@ -0,0 +1,151 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <radio_tool/util/thread_pool.hpp>
+
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <exception>
+
+using namespace radio_tool;
+
+ThreadPool::ThreadPool(const size_t& n)
+	: stop(false)
+{
+	workers.reserve(n);
+	for (auto x = 0u; x < n; x++)
+	{
+		workers.emplace_back(&ThreadPool::Run, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lk(lock);
+		stop = true;
+	}
+	wake.notify_all();
+	for (auto& w : workers)
+	{
+		w.join();
+	}
+}
+
+auto ThreadPool::Global() -> ThreadPool&
+{
+	static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+	return pool;
+}
+
+auto ThreadPool::Run() -> void
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lk(lock);
+			wake.wait(lk, [this] { return stop || !jobs.empty(); });
+			if (stop && jobs.empty())
+			{
+				return;
+			}
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		job();
+	}
+}
+
+/**
+ * Indices shared by the caller and helpers of one ParallelFor, helpers which
+ * start after the last index was taken find nothing to do and never touch fn
+ */
+class ParallelForState
+{
+public:
+	ParallelForState(const size_t& count, const std::function<void(const size_t&)>& fn)
+		: count(count), fn(fn), next(0), done(0) {}
+
+	const size_t count;
+	const std::function<void(const size_t&)>& fn;
+	std::atomic<size_t> next;
+
+	std::mutex lock;
+	std::condition_variable finished;
+	size_t done;
+	std::exception_ptr error;
+
+	auto Work() -> void
+	{
+		size_t i;
+		while ((i = next++) < count)
+		{
+			std::exception_ptr ex;
+			try
+			{
+				fn(i);
+			}
+			catch (...)
+			{
+				ex = std::current_exception();
+			}
+
+			std::lock_guard<std::mutex> lk(lock);
+			if (ex && !error)
+			{
+				error = ex;
+			}
+			if (++done == count)
+			{
+				finished.notify_all();
+			}
+		}
+	}
+};
+
+auto ThreadPool::ParallelFor(const size_t& count, const std::function<void(const size_t&)>& fn) -> void
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	auto state = std::make_shared<ParallelForState>(count, fn);
+	auto helpers = std::min(workers.size(), count - 1);
+	if (helpers > 0)
+	{
+		{
+			std::lock_guard<std::mutex> lk(lock);
+			for (auto x = 0u; x < helpers; x++)
+			{
+				jobs.push_back([state] { state->Work(); });
+			}
+		}
+		wake.notify_all();
+	}
+
+	state->Work();
+
+	std::unique_lock<std::mutex> lk(state->lock);
+	state->finished.wait(lk, [&state] { return state->done == state->count; });
+	if (state->error)
+	{
+		std::rethrow_exception(state->error);
+	}
+}
@@ -44,19 +44,17 @@ auto TYTFW::Read(const std::string& file) -> void
 			binarySize += rLength;
 		}
 
-		//skip to binary
-		i.seekg(HeaderSize);
-
-		data.resize(binarySize);
-		i.read((char*)data.data(), data.size());
+		i.close();
 
 		//meh ignore footer
+		LoadPayload(file, HeaderSize, binarySize);
 	}
-	i.close();
 }
 
 auto TYTFW::Write(const std::string& file) -> void
 {
+	Materialize();
+
 	std::ofstream fout(file, std::ios_base::binary);
 	if (fout.is_open())
 	{
@@ -117,7 +115,7 @@ auto TYTFW::ToString() const -> std::string
 	std::stringstream out;
 	out << "== TYT Firmware == " << std::endl
 		<< "Radio: " << firmware_model << " (" << radio_model << ")" << std::endl
-		<< "Size:  " << FormatBytes(data.size()) << std::endl
+		<< "Size:  " << FormatBytes(PayloadSize()) << std::endl
 		<< "Data Segments: " << std::endl;
 	auto n = 0;
 	for (const auto& m : memory_ranges)
@@ -236,35 +234,25 @@ auto TYTFW::SetRadioModel(const std::string& model) -> void
 
 auto TYTFW::Decrypt() -> void
 {
-	ApplyXOR();
+	Transform(CipherDirection::Decrypt);
 }
 
 auto TYTFW::Encrypt() -> void
 {
-	ApplyXOR();
+	Transform(CipherDirection::Encrypt);
 }
 
-auto TYTFW::ApplyXOR() -> void
+auto TYTFW::GetCipher() const -> std::shared_ptr<const cipher::Cipher>
 {
-	const uint8_t* xor_model = nullptr;
-	uint32_t xor_len = 1024;
-
 	for (const auto& r : tyt::config::All)
 	{
 		if (std::equal(r.counter_magic.begin(), r.counter_magic.end(), counterMagic.begin(), counterMagic.end()))
 		{
-			xor_model = r.cipher;
-			xor_len = r.cipher_len;
-			break;
+			return std::make_shared<cipher::XORCipher>(r.cipher, r.cipher_len);
 		}
 	}
 
-	if (xor_model == nullptr)
-	{
-		throw std::runtime_error("No cipher found");
-	}
-
-	radio_tool::ApplyXOR(data, xor_model, xor_len);
+	throw std::runtime_error("No cipher found");
 }
 
 auto TYTFW::IsCompatible(const FirmwareSupport* Other) const -> bool
@@ -51,18 +51,8 @@ auto TYTSGLFW::Read(const std::string& file) -> void
 		throw std::runtime_error(msg.str());
 	}
 
-	auto i = std::ifstream(file, std::ios_base::binary);
-	if (i.is_open())
-	{
-		i.seekg(0x400, i.beg);
-		i.seekg(hdr.binary_offset, i.cur);
-
-		data.resize(hdr.length);
-		i.read((char*)data.data(), hdr.length);
-
-		memory_ranges.push_back(std::pair<uint32_t, uint32_t>(0, data.size()));
-	}
-	i.close();
+	LoadPayload(file, HeaderLen + hdr.binary_offset, hdr.length);
+	memory_ranges.push_back(std::pair<uint32_t, uint32_t>(0, hdr.length));
 }
 
 auto TYTSGLFW::Write(const std::string& file) -> void
@@ -70,9 +60,10 @@ auto TYTSGLFW::Write(const std::string& file) -> void
 	if (config == nullptr) {
 		throw std::runtime_error("No header set, cannot write firmware");
 	}
-	if (config->header.length != data.size()) {
+	if (config->header.length != PayloadSize()) {
 		throw std::runtime_error("Binary size mismatch, size in header does not match actual binary length");
 	}
+	Materialize();
 
 	std::ofstream fout(file, std::ios_base::binary);
 	if (fout.is_open())
@@ -197,7 +188,7 @@ auto TYTSGLFW::SetRadioModel(const std::string& model) -> void
 	{
 		if (rg.radio_model == model)
 		{
-			config = new TYTSGLRadioConfig(rg.radio_model, rg.header.AsNew(data.size()), rg.cipher, rg.cipher_len, rg.xor_offset);
+			config = new TYTSGLRadioConfig(rg.radio_model, rg.header.AsNew(PayloadSize()), rg.cipher, rg.cipher_len, rg.xor_offset);
 			break;
 		}
 	}
@@ -205,12 +196,7 @@ auto TYTSGLFW::SetRadioModel(const std::string& model) -> void
 
 auto TYTSGLFW::Decrypt() -> void
 {
-	auto cx = 0;
-	for (auto& dx : data)
-	{
-		dx = ~(((dx << 3) & 0b11111000) | ((dx >> 5) & 0b00000111));
-		dx = dx ^ config->cipher[(config->xor_offset + cx++) % config->cipher_len];
-	}
+	Transform(CipherDirection::Decrypt);
 }
 
 auto TYTSGLFW::Encrypt() -> void
@@ -219,17 +205,21 @@ auto TYTSGLFW::Encrypt() -> void
 	// if too short add padding
 	// if too big? ...official firmware writing tool wont work probably
 	// padding is normally handled by FirmwareSupport::AppendSegment
-	if (data.size() < config->header.length)
+	if (PayloadSize() < config->header.length)
 	{
+		Materialize();
 		std::fill_n(std::back_inserter(data), config->header.length - data.size(), 0xff);
 	}
 
-	auto cx = 0;
-	for (auto& dx : data)
-	{
-		dx = dx ^ config->cipher[(config->xor_offset + cx++) % config->cipher_len];
-		dx = ~(((dx >> 3) & 0b00011111) | ((dx << 5) & 0b11100000));
+	Transform(CipherDirection::Encrypt);
+}
+
+auto TYTSGLFW::GetCipher() const -> std::shared_ptr<const cipher::Cipher>
+{
+	if (config == nullptr) {
+		throw std::runtime_error("No header set, cannot get cipher");
 	}
+	return std::make_shared<cipher::SGLCipher>(config->cipher, config->cipher_len, config->xor_offset);
 }
 
 auto TYTSGLFW::IsCompatible(const FirmwareSupport* other) const -> bool
@@ -29,19 +29,16 @@ auto TYTHID::Setup() -> void
 	err = libusb_set_configuration(device, 0x01);
 	if (err != LIBUSB_SUCCESS)
 	{
-		libusb_close(device);
 		throw std::runtime_error(libusb_error_name(err));
 	}
 	err = libusb_claim_interface(device, 0x00);
 	if (err != LIBUSB_SUCCESS)
 	{
-		libusb_close(device);
 		throw std::runtime_error(libusb_error_name(err));
 	}
 	err = libusb_control_transfer(device, 0x21, 0x0a, 0, 0, nullptr, 0, timeout);
 	if (err != LIBUSB_SUCCESS)
 	{
-		libusb_close(device);
 		throw std::runtime_error(libusb_error_name(err));
 	}
     /*
@@ -82,15 +79,21 @@ auto TYTHID::OnTransfer(libusb_transfer* tx) -> void
 
 auto TYTHID::SendCommand(const tyt::Command& cmd) -> tyt::Command
 {
-	std::vector<uint8_t> payload((int)cmd.data.size() + 4);
-	std::fill(payload.begin(), payload.end(), 0x00);
+	return SendCommand(cmd.type, { cmd.data });
+}
+
+auto TYTHID::SendCommand(const tyt::CommandType& cmd_type, std::initializer_list<std::span<const uint8_t>> parts) -> tyt::Command
+{
+	constexpr auto HeaderSize = 4u;
 
-	auto nums = (uint16_t*)payload.data();
-	nums[0] = (uint16_t)cmd.type;
-	nums[1] = cmd.data.size();
-	std::copy(cmd.data.begin(), cmd.data.end(), payload.begin() + 4);
+	uint8_t payload[MaxGatherSize];
+	auto payload_len = Gather(std::span<uint8_t>(payload + HeaderSize, MaxGatherSize - HeaderSize), parts);
 
-	InterruptWrite(TYTHID::EP_OUT, payload);
+	auto nums = (uint16_t*)payload;
+	nums[0] = (uint16_t)cmd_type;
+	nums[1] = payload_len;
+
+	InterruptWrite(TYTHID::EP_OUT, std::span<const uint8_t>(payload, HeaderSize + payload_len));
     auto data = InterruptRead(TYTHID::EP_IN, 42);
     auto type = ((uint16_t)data[1] << 8) | data[0];
     auto len  = ((uint16_t)data[3] << 8) | data[2];
@@ -100,7 +103,7 @@ auto TYTHID::SendCommand(const tyt::Command& cmd) -> tyt::Command
 
 auto TYTHID::SendCommand(const std::vector<uint8_t>& cmd) -> tyt::Command
 {
-	return SendCommand(tyt::Command(tyt::CommandType::HostToDevice, cmd.size(), cmd));
+	return SendCommand(tyt::CommandType::HostToDevice, { cmd });
 }
 
 auto TYTHID::SendCommand(const std::vector<uint8_t>& cmd, const uint8_t& size, const uint8_t& fill) -> tyt::Command
@@ -162,4 +165,14 @@ auto TYTHID::SendCommandAndOk(const std::vector<uint8_t>& cmd, const uint8_t& si
 		radio_tool::PrintHex(ok.data.begin(), ok.data.end());
 		throw std::runtime_error("Invalid usb response from device");
 	}
+}
+
+auto TYTHID::SendCommandAndOk(const tyt::CommandType& type, std::initializer_list<std::span<const uint8_t>> parts) -> void
+{
+    auto ok = SendCommand(type, parts);
+	if (!(ok == tyt::OKResponse))
+	{
+		radio_tool::PrintHex(ok.data.begin(), ok.data.end());
+		throw std::runtime_error("Invalid usb response from device");
+	}
 }
\ No newline at end of file
@@ -19,12 +19,17 @@
 #include <radio_tool/dfu/dfu.hpp>
 #include <radio_tool/dfu/tyt_dfu.hpp>
 #include <radio_tool/fw/tyt_fw.hpp>
+#include <radio_tool/fw/fw_stream.hpp>
+#include <radio_tool/dfu/dfu_exception.hpp>
+#include <radio_tool/dfu/dfu_erase_planner.hpp>
 #include <radio_tool/util/flash.hpp>
+#include <radio_tool/util.hpp>
 
 #include <math.h>
 #include <iomanip>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 
 using namespace radio_tool::radio;
 
@@ -38,54 +43,142 @@ auto TYTRadio::ToString() const -> const std::string
 	out << "== TYT Radio Info ==" << std::endl
 		<< "Radio: " << model << std::endl
 		<< "RTC: " << (time == -1 ? "N/A" : ctime(&time));
+	if (const auto& desc = dfu.GetFunctionalDescriptor())
+	{
+		out << "DFU: " << desc->ToString() << std::endl;
+	}
 
 	return out.str();
 }
 
 auto TYTRadio::WriteFirmware(const std::string& file) -> void
 {
-	constexpr auto TransferSize = 1024u;
+	const auto TransferSize = dfu.TransferSize();
 
+	//the binary is read one sector at a time while the previous sector is written
 	auto fw = fw::TYTFW();
+	fw.SetReadMode(fw::ReadMode::Streamed);
 	fw.Read(file);
 
-	auto dfu = this->dfu;
+	const auto& dfu = this->dfu;
+	dfu.GetPollScheduler().SetModel(fw.GetRadioModel());
 	dfu.SendTYTCommand(dfu::TYTCommand::FirmwareUpgrade);
-	for (auto& r : fw.GetDataSegments())
+
+	//differential flashing keeps unchanged sectors, so it can never mass erase
+	auto planner = dfu::DFUErasePlanner(flash::STM32F40X, BootloaderSectors, !differential);
+	planner.SetModel(fw.GetRadioModel());
+	auto ranges = std::vector<std::pair<uint32_t, uint32_t>>();
+	for (const auto& s : fw.GetDataSegments())
+	{
+		ranges.push_back({ s.address, s.size });
+	}
+	const auto plan = planner.Plan(ranges);
+	Log() << plan.ToString() << std::endl;
+	if (plan.strategy == dfu::EraseStrategy::Mass)
+	{
+		planner.Execute(dfu, plan);
+	}
+
+	//sectors can be split over more than one block, only erase them before the first
+	auto erased = std::vector<bool>(flash::STM32F40X.Sectors(), plan.strategy == dfu::EraseStrategy::Mass);
+	auto visited = std::vector<bool>(flash::STM32F40X.Sectors(), false);
+
+	//differential flashing decides per sector using every block in it, when two segments share a sector
+	//the first would otherwise see the seconds area as erased, match, and be wiped by the seconds erase
+	auto writeSector = [&](std::vector<fw::FirmwareBlock>& blocks, const fw::FirmwareStream& stream)
+	{
+		const auto& sector = blocks.front().sector.value();
+		if (differential)
+		{
+			if (visited[sector.index])
+			{
+				throw std::runtime_error("Differential flashing needs segments sharing a sector to be next to each other: " + sector.ToString());
+			}
+			visited[sector.index] = true;
+
+			//the bootloader decrypts while writing, readback is compared against the plain image
+			auto plain = blocks;
+			for (auto& p : plain)
+			{
+				stream.TransformBlock(fw::CipherDirection::Decrypt, p.data, p);
+			}
+			if (SectorMatches(sector, ExpectedSector(sector, plain)))
+			{
+				Log() << "Unchanged: " << sector.ToString() << std::endl;
+				return;
+			}
+		}
+
+		if (!erased[sector.index])
+		{
+			Log() << "Erasing: 0x" << std::setw(8) << std::setfill('0') << std::hex << sector.start
+				<< " [Size=0x" << std::hex << sector.size << "]" << std::endl
+				<< "-- " << sector.ToString() << std::endl;
+			dfu.Erase(sector.start, sector.size);
+			erased[sector.index] = true;
+		}
+
+		for (const auto& block : blocks)
+		{
+			const auto size = static_cast<uint32_t>(block.data.size());
+			Log() << "Writing: 0x" << std::setw(8) << std::setfill('0') << std::hex << block.address
+				<< " [Size=0x" << std::hex << size << "]" << std::endl;
+			dfu.SetAddress(block.address);
+
+			//blocks are numbered from 2, the device writes block N to addr + (N - 2) * wTransferSize
+			dfu.DownloadBlocks(block.data.data(), size, TransferSize, 2);
+		}
+	};
+
+	auto stream = fw::FirmwareStream(fw, flash::STM32F40X);
+	auto pending = std::vector<fw::FirmwareBlock>();
+	while (auto block = stream.Next())
+	{
+		if (!pending.empty() && pending.front().sector->index != block->sector->index)
+		{
+			writeSector(pending, stream);
+			pending.clear();
+		}
+		pending.push_back(std::move(block.value()));
+	}
+	if (!pending.empty())
 	{
-		flash::FlashUtil::AlignedContiguousMemoryOp(flash::STM32F40X, r.address, r.address + r.size,
-			[&dfu](const uint32_t& addr, const uint32_t& size, const flash::FlashSector& sector) {
-				std::cerr << "Erasing: 0x" << std::setw(8) << std::setfill('0') << std::hex << addr
-					<< " [Size=0x" << std::hex << size << "]" << std::endl
-					<< "-- " << sector.ToString() << std::endl;
-
-				dfu.Erase(addr);
-			});
-
-		auto b_offset = 0u;
-		flash::FlashUtil::AlignedContiguousMemoryOp(flash::STM32F40X, r.address, r.address + r.size,
-			[&dfu, &r, &TransferSize, &b_offset](const uint32_t& addr, const uint32_t& size, const flash::FlashSector&) {
-				const auto& binary_data = r.data;
-				const auto blocks = (int)ceil(size / (double)TransferSize);
-
-				std::cerr << "Writing: 0x" << std::setw(8) << std::setfill('0') << std::hex << addr
-					<< " [Size=0x" << std::hex << size << "]" << std::endl;
-				dfu.SetAddress(addr);
-				for (auto wValue = 0; wValue < blocks; wValue++)
-				{
-					auto block_offset = b_offset + (TransferSize * wValue);
-					auto to_write = std::vector<uint8_t>(
-						binary_data.begin() + block_offset,
-						binary_data.begin() + block_offset + std::min(TransferSize, r.size - block_offset)
-						);
-
-					/*std::cerr
-						<< "-- wValue=0x" << std::setw(2) << std::setfill('0') << std::hex << (2 + wValue)
-						<< ", Size=0x" << to_write.size()
-						<< std::endl;*/
-					dfu.Download(to_write, 2 + wValue);
-				}
-				b_offset += size;
-			});
+		writeSector(pending, stream);
 	}
-}
\ No newline at end of file
+
+	Log() << dfu::DFUTimingTable::Global().ToString();
+}
+
+auto TYTRadio::ExpectedSector(const flash::FlashSector& sector, const std::vector<fw::FirmwareBlock>& blocks) -> std::vector<uint8_t>
+{
+	auto expected = std::vector<uint8_t>(sector.size, 0xff);
+	for (const auto& block : blocks)
+	{
+		if (block.address < sector.start || block.address - sector.start + block.data.size() > sector.size)
+		{
+			throw std::invalid_argument("Block is not inside sector " + sector.ToString());
+		}
+		std::copy(block.data.begin(), block.data.end(), expected.begin() + (block.address - sector.start));
+	}
+	return expected;
+}
+
+auto TYTRadio::SectorMatches(const flash::FlashSector& sector, const std::vector<uint8_t>& expected) const -> bool
+{
+	const auto TransferSize = dfu.TransferSize();
+
+	auto actual = std::vector<uint8_t>(sector.size);
+	try
+	{
+		dfu.SetAddress(sector.start);
+		dfu.UploadBlocks(actual.data(), actual.size(), TransferSize, 2);
+	}
+	catch (const dfu::DFUException& ex)
+	{
+		//cant verify it, so write it
+		Log() << "Readback failed: " << ex.what() << std::endl;
+		return false;
+	}
+
+	return std::equal(expected.begin(), expected.end(), actual.begin());
+}
@@ -24,6 +24,7 @@
 #include <iostream>
 #include <vector>
 #include "radio_tool/util.hpp"
+#include <radio_tool/util/checksum.hpp>
 
 using namespace radio_tool::radio;
 
@@ -93,20 +94,25 @@ auto TYTSGLRadio::WriteFirmware(const std::string &file) -> void
 	constexpr auto HeaderSize = 0x06u;
 	constexpr auto ChecksumBlockSize = 0x400u;
 
-	auto buf = std::vector<uint8_t>(TransferSize + HeaderSize);
-	auto binary = fw.GetDataSegments()[0];
-	auto address = 0;
+	//header is built on the stack, payload is sent straight from the firmware buffer
+	uint8_t header[HeaderSize];
+	const uint8_t padding[TransferSize] = {};
+	const auto& binary = fw.GetDataSegments()[0];
+	const std::span<const uint8_t> payload = binary.data;
+	auto address = 0u;
 	auto checksumBlock = 0;
 	while (address < binary.size)
 	{
 		auto transferSize = std::min(TransferSize, binary.size - address);
-        *(uint32_t *)buf.data() = bswap32(address);
-        *(uint16_t *)(buf.data() + 4) = bswap16(transferSize);
+        *(uint32_t *)header = bswap32(address);
+        *(uint16_t *)(header + 4) = bswap16(transferSize);
 
-		auto src = binary.data.begin() + address;
-		std::copy(src, src + transferSize, buf.begin() + HeaderSize);
-
-		device.SendCommandAndOk(buf);
+		//frames are always TransferSize + HeaderSize long
+		device.SendCommandAndOk(hid::tyt::CommandType::HostToDevice, {
+			header,
+			payload.subspan(address, transferSize),
+			std::span<const uint8_t>(padding, TransferSize - transferSize)
+		});
 
 		address += transferSize;
 		if (address % ChecksumBlockSize == 0 || address == binary.size)
@@ -116,22 +122,16 @@ auto TYTSGLRadio::WriteFirmware(const std::string &file) -> void
 
 			auto checksumCommand = std::vector<uint8_t>(hid::tyt::commands::End.size() + 5, 0xff);
 			std::copy(hid::tyt::commands::End.begin(), hid::tyt::commands::End.end(), checksumCommand.begin());
-			*(uint32_t *)(checksumCommand.data() + hid::tyt::commands::End.size() + 1) = checksum(binary.data.begin() + start, binary.data.begin() + end);
+			*(uint32_t *)(checksumCommand.data() + hid::tyt::commands::End.size() + 1) = checksum(payload.subspan(start, end - start));
 			device.SendCommandAndOk(checksumCommand);
 
 			checksumBlock++;
-            std::cerr << "Sent block " << checksumBlock << std::endl;
+            Log() << "Sent block " << checksumBlock << std::endl;
         }
 	}
 }
 
-auto TYTSGLRadio::checksum(std::vector<uint8_t>::const_iterator &&begin, std::vector<uint8_t>::const_iterator &&end) const -> uint32_t
+auto TYTSGLRadio::checksum(std::span<const uint8_t> data) const -> uint32_t
 {
-	uint32_t counter = 0;
-	while (begin != end)
-	{
-		counter += *begin;
-		std::advance(begin, 1);
-	}
-	return counter;
+	return checksum::Sum32Checksum().Update(data).Finalize();
 }
\ No newline at end of file
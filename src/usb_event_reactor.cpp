@@ -0,0 +1,294 @@
+/**
+ * This file is part of radio_tool.
+ * Copyright (c) 2022 v0l <radio_tool@v0l.io>
+ *
+ * radio_tool is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * radio_tool is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with radio_tool. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <radio_tool/radio/usb_event_reactor.hpp>
+
+#include <stdexcept>
+#include <sstream>
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#elif !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#endif
+
+using namespace radio_tool::radio;
+
+USBEventReactor::USBEventReactor(libusb_context *ctx)
+	: ctx(ctx), running(true)
+{
+#if defined(__linux__)
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (epoll_fd < 0)
+	{
+		throw std::runtime_error("Failed to create epoll instance");
+	}
+	wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (wake_fd < 0)
+	{
+		close(epoll_fd);
+		throw std::runtime_error("Failed to create eventfd");
+	}
+	//the wake descriptor is tagged with -1 so it is never mistaken for a libusb descriptor
+	epoll_event ev = {};
+	ev.events = EPOLLIN;
+	ev.data.fd = -1;
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev) != 0)
+	{
+		auto err = errno;
+		close(wake_fd);
+		close(epoll_fd);
+		throw std::runtime_error(std::string("Failed to watch eventfd: ") + std::strerror(err));
+	}
+#elif !defined(_WIN32)
+	if (pipe(wake_pipe) != 0)
+	{
+		throw std::runtime_error("Failed to create wake pipe");
+	}
+	for (auto fd : wake_pipe)
+	{
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+	}
+#endif
+
+#ifndef _WIN32
+	//register the notifiers before reading the current set so no descriptor is missed
+	libusb_set_pollfd_notifiers(ctx, OnPollfdAdded, OnPollfdRemoved, this);
+	auto pollfds = libusb_get_pollfds(ctx);
+	if (pollfds != nullptr)
+	{
+		try
+		{
+			for (auto p = pollfds; *p != nullptr; p++)
+			{
+#if defined(__linux__)
+				Watch((*p)->fd, (*p)->events);
+#else
+				OnPollfdAdded((*p)->fd, (*p)->events, this);
+#endif
+			}
+		}
+		catch (...)
+		{
+			libusb_free_pollfds(pollfds);
+			libusb_set_pollfd_notifiers(ctx, nullptr, nullptr, nullptr);
+#if defined(__linux__)
+			close(wake_fd);
+			close(epoll_fd);
+#endif
+			throw;
+		}
+		libusb_free_pollfds(pollfds);
+	}
+#endif
+
+	thread = std::thread(&USBEventReactor::Run, this);
+}
+
+USBEventReactor::~USBEventReactor()
+{
+	Stop();
+
+#ifndef _WIN32
+	libusb_set_pollfd_notifiers(ctx, nullptr, nullptr, nullptr);
+#endif
+#if defined(__linux__)
+	close(wake_fd);
+	close(epoll_fd);
+#elif !defined(_WIN32)
+	close(wake_pipe[0]);
+	close(wake_pipe[1]);
+#endif
+}
+
+auto USBEventReactor::Stop() -> void
+{
+	if (running.exchange(false))
+	{
+		Wake();
+	}
+	if (thread.joinable())
+	{
+		thread.join();
+	}
+}
+
+auto USBEventReactor::Run() -> void
+{
+	while (running)
+	{
+		Wait(NextTimeout());
+		if (!running)
+		{
+			break;
+		}
+
+#ifdef _WIN32
+		auto err = libusb_handle_events(ctx);
+#else
+		//descriptors are already known to be ready, dont block inside libusb
+		timeval zero = {0, 0};
+		auto err = libusb_handle_events_timeout(ctx, &zero);
+#endif
+		if (err != LIBUSB_SUCCESS &&
+			err != LIBUSB_ERROR_BUSY &&
+			err != LIBUSB_ERROR_TIMEOUT &&
+			err != LIBUSB_ERROR_OVERFLOW &&
+			err != LIBUSB_ERROR_INTERRUPTED)
+		{
+			break;
+		}
+	}
+}
+
+auto USBEventReactor::NextTimeout() const -> int
+{
+	timeval tv = {};
+	if (libusb_get_next_timeout(ctx, &tv) == 1)
+	{
+		//round up so the timeout has expired when libusb is called
+		return static_cast<int>(tv.tv_sec * 1000 + (tv.tv_usec + 999) / 1000);
+	}
+	return -1;
+}
+
+#if defined(__linux__)
+auto USBEventReactor::Wait(const int &timeout_ms) -> void
+{
+	epoll_event ev[16];
+	auto n = epoll_wait(epoll_fd, ev, 16, timeout_ms);
+	for (auto x = 0; x < n; x++)
+	{
+		if (ev[x].data.fd == -1)
+		{
+			uint64_t count;
+			while (read(wake_fd, &count, sizeof(count)) > 0)
+			{
+			}
+		}
+	}
+}
+
+auto USBEventReactor::Wake() -> void
+{
+	uint64_t one = 1;
+	[[maybe_unused]] auto r = write(wake_fd, &one, sizeof(one));
+}
+
+auto USBEventReactor::Watch(const int &fd, const short &events) -> void
+{
+	epoll_event ev = {};
+	ev.events = ((events & POLLIN) ? uint32_t(EPOLLIN) : 0u) | ((events & POLLOUT) ? uint32_t(EPOLLOUT) : 0u);
+	ev.data.fd = fd;
+	auto err = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+	if (err != 0 && errno == EEXIST)
+	{
+		err = epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+	}
+	if (err != 0)
+	{
+		std::stringstream msg;
+		msg << "Failed to watch USB descriptor " << fd << ": " << std::strerror(errno);
+		throw std::runtime_error(msg.str());
+	}
+}
+
+void LIBUSB_CALL USBEventReactor::OnPollfdAdded(int fd, short events, void *user_data)
+{
+	auto self = static_cast<USBEventReactor *>(user_data);
+	try
+	{
+		self->Watch(fd, events);
+	}
+	catch (const std::exception &ex)
+	{
+		//cant throw through libusb, transfers on this descriptor will only complete on a libusb timeout
+		std::cerr << ex.what() << std::endl;
+	}
+}
+
+void LIBUSB_CALL USBEventReactor::OnPollfdRemoved(int fd, void *user_data)
+{
+	auto self = static_cast<USBEventReactor *>(user_data);
+	epoll_ctl(self->epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+}
+#elif !defined(_WIN32)
+auto USBEventReactor::Wait(const int &timeout_ms) -> void
+{
+	std::vector<pollfd> set;
+	{
+		auto lk = std::lock_guard<std::mutex>(lock);
+		set = fds;
+	}
+	set.push_back({wake_pipe[0], POLLIN, 0});
+
+	if (poll(set.data(), set.size(), timeout_ms) > 0 && (set.back().revents & POLLIN))
+	{
+		char drain[64];
+		while (read(wake_pipe[0], drain, sizeof(drain)) > 0)
+		{
+		}
+	}
+}
+
+auto USBEventReactor::Wake() -> void
+{
+	char one = 1;
+	[[maybe_unused]] auto r = write(wake_pipe[1], &one, sizeof(one));
+}
+
+void LIBUSB_CALL USBEventReactor::OnPollfdAdded(int fd, short events, void *user_data)
+{
+	auto self = static_cast<USBEventReactor *>(user_data);
+	{
+		auto lk = std::lock_guard<std::mutex>(self->lock);
+		self->fds.push_back({fd, events, 0});
+	}
+	//poll works on a copy of the set, restart it so the new descriptor is watched
+	self->Wake();
+}
+
+void LIBUSB_CALL USBEventReactor::OnPollfdRemoved(int fd, void *user_data)
+{
+	auto self = static_cast<USBEventReactor *>(user_data);
+	{
+		auto lk = std::lock_guard<std::mutex>(self->lock);
+		self->fds.erase(std::remove_if(self->fds.begin(), self->fds.end(), [fd](const pollfd &p)
+									   { return p.fd == fd; }),
+						self->fds.end());
+	}
+	self->Wake();
+}
+#else
+auto USBEventReactor::Wait(const int &) -> void
+{
+	//libusb_handle_events blocks until something happens
+}
+
+auto USBEventReactor::Wake() -> void
+{
+	libusb_interrupt_event_handler(ctx);
+}
+#endif
@@ -25,17 +25,17 @@
 
 #include <exception>
 #include <functional>
+#include <utility>
 #include <codecvt>
 #include <cstring>
 #include <iostream>
-#include <thread>
 
 using namespace radio_tool::radio;
 
 struct DeviceMapper
 {
 	std::function<bool(const libusb_device_descriptor &)> SupportsDevice;
-	std::function<RadioOperations *(libusb_device_handle *)> CreateOperations;
+	std::function<RadioOperations *(libusb_device_handle *, libusb_context *)> CreateOperations;
 };
 
 /**
@@ -46,24 +46,67 @@ const std::vector<DeviceMapper> RadioSupports = {
 	{TYTSGLRadio::SupportsDevice, TYTSGLRadio::Create},
 	{YaesuRadio::SupportsDevice, YaesuRadio::Create}};
 
+USBRadioInfo::USBRadioInfo(
+	const CreateUSBRadioOps l,
+	libusb_context *ctx,
+	libusb_device *dev,
+	const std::wstring &mfg,
+	const std::wstring &prd,
+	const uint16_t &vid,
+	const uint16_t &pid,
+	const uint16_t &idx)
+	: RadioInfo(idx, mfg, prd, ""), vid(vid), pid(pid),
+	  bus(libusb_get_bus_number(dev)), root_port(USBRadioFactory::GetRootPort(dev)), address(libusb_get_device_address(dev)),
+	  loader(l), ctx(ctx), device(libusb_ref_device(dev))
+{
+}
+
+USBRadioInfo::~USBRadioInfo()
+{
+	libusb_unref_device(device);
+}
+
+auto USBRadioInfo::OpenDevice() const -> RadioHandle
+{
+	libusb_device_handle *h;
+	auto err = libusb_open(device, &h);
+	if (err != LIBUSB_SUCCESS)
+	{
+		throw std::runtime_error(libusb_error_name(err));
+	}
+
+	try
+	{
+		//the handle is only closed here, drivers must not close it themselves
+		auto release = std::function<void(RadioOperations *)>([h](RadioOperations *radio)
+															  {
+			delete radio;
+			libusb_close(h); });
+		auto radio = loader(h, ctx);
+		return RadioHandle(radio, std::move(release));
+	}
+	catch (...)
+	{
+		libusb_close(h);
+		throw;
+	}
+}
+
 USBRadioFactory::USBRadioFactory() : usb_ctx(nullptr)
 {
 	usb_ctx = CreateContext();
-	events = std::thread(&USBRadioFactory::HandleEvents, this);
+	events = std::make_unique<USBEventReactor>(usb_ctx);
 }
 
 USBRadioFactory::~USBRadioFactory()
 {
-	auto ctx = usb_ctx;
-	usb_ctx = nullptr;
-	events.join();
-
-	libusb_exit(ctx);
+	events.reset();
+	libusb_exit(usb_ctx);
 }
 
-auto USBRadioFactory::ListDevices(const uint16_t &idx_offset) const -> const std::vector<RadioInfo *>
+auto USBRadioFactory::ListDevices(const uint16_t &idx_offset) const -> std::vector<std::unique_ptr<RadioInfo>>
 {
-	std::vector<RadioInfo *> ret;
+	std::vector<std::unique_ptr<RadioInfo>> ret;
 
 	libusb_device **devs;
 	auto ndev = libusb_get_device_list(usb_ctx, &devs);
@@ -105,18 +148,7 @@ auto USBRadioFactory::ListDevices(const uint16_t &idx_offset) const -> const std
 								prd = GetDeviceString(desc.iProduct, h);
 							}
 
-							auto bus = libusb_get_bus_number(cdev);
-							auto port = libusb_get_port_number(cdev);
-							auto addr = libusb_get_device_address(cdev);
-
-							auto fnOpen = [bus, port, addr, &fnSupport]()
-							{
-								auto openDev = OpenDevice(bus, port, addr);
-								return fnSupport.CreateOperations(openDev);
-							};
-
-							auto nInf = new USBRadioInfo(fnOpen, mfg, prd, desc.idVendor, desc.idProduct, idx_offset + n_idx);
-							ret.push_back(nInf);
+							ret.push_back(std::make_unique<USBRadioInfo>(fnSupport.CreateOperations, usb_ctx, cdev, mfg, prd, desc.idVendor, desc.idProduct, idx_offset + n_idx));
 							n_idx++;
 							libusb_close(h);
 						}
@@ -171,46 +203,16 @@ auto USBRadioFactory::GetDeviceString(const uint8_t &desc, libusb_device_handle
 	return std::wstring(u16.begin(), u16.end());
 }
 
-auto USBRadioFactory::OpenDevice(const uint8_t &bus, const uint8_t &port, const uint8_t &address) -> libusb_device_handle *
+auto USBRadioFactory::GetRootPort(libusb_device *dev) -> uint8_t
 {
-	auto usb_ctx = CreateContext();
-
-	libusb_device **devs;
-	auto ndev = libusb_get_device_list(usb_ctx, &devs);
-	int err = LIBUSB_SUCCESS;
-	auto n_idx = 0;
-
-	if (ndev >= 0)
+	// USB 3.0 allows at most 7 tiers
+	uint8_t path[7];
+	auto depth = libusb_get_port_numbers(dev, path, sizeof(path));
+	if (depth > 0)
 	{
-		for (auto x = 0; x < ndev; x++)
-		{
-			auto b = libusb_get_bus_number(devs[x]);
-			auto p = libusb_get_port_number(devs[x]);
-			auto a = libusb_get_device_address(devs[x]);
-			if (b == bus && p == port && a == address)
-			{
-				libusb_device_handle *handle;
-
-				if ((err = libusb_open(devs[x], &handle)) == LIBUSB_SUCCESS)
-				{
-					return handle;
-				}
-				else
-				{
-					throw std::runtime_error(libusb_error_name(err));
-				}
-				break;
-			}
-		}
-
-		libusb_free_device_list(devs, 1);
+		return path[0];
 	}
-	else
-	{
-		throw std::runtime_error(libusb_error_name(ndev));
-	}
-
-	return nullptr;
+	return libusb_get_port_number(dev);
 }
 
 auto USBRadioFactory::CreateContext() -> libusb_context *
@@ -231,22 +233,3 @@ auto USBRadioFactory::CreateContext() -> libusb_context *
 
 	return usb_ctx;
 }
-
-auto USBRadioFactory::HandleEvents() -> void
-{
-	while (usb_ctx != nullptr)
-	{
-		timeval timeout = {0, 100};
-		auto err = libusb_handle_events_timeout(usb_ctx, &timeout);
-		if (err != LIBUSB_SUCCESS)
-		{
-			if (err != LIBUSB_ERROR_BUSY &&
-				err != LIBUSB_ERROR_TIMEOUT &&
-				err != LIBUSB_ERROR_OVERFLOW &&
-				err != LIBUSB_ERROR_INTERRUPTED)
-			{
-				break;
-			}
-		}
-	}
-}
\ No newline at end of file
@@ -29,20 +29,27 @@ auto YaesuFW::Read(const std::string& file) -> void
 		// Compute binary file size
 		i.seekg(0, std::ios_base::end);
 		auto binarySize = i.tellg();
-		i.seekg(0);
+		i.close();
 
 		// Read binary
-		data.resize(binarySize);
-		i.read((char*)data.data(), binarySize);
+		LoadPayload(file, 0, binarySize);
 
-		// Pad with 0xFF until multiple of 1KiB
-		data.resize(binarySize + ((1024 - binarySize % 1024) % 1024), 0xFF);
+		// Pad with 0xFF until multiple of 1KiB. Mapped and buffered binaries are materialized and padded.
+		// Streamed binaries already read as 0xFF past their end.
+		auto paddedSize = binarySize + ((1024 - binarySize % 1024) % 1024);
+		memory_ranges.push_back(std::make_pair(0, paddedSize));
+		if (paddedSize != binarySize && GetReadMode() != ReadMode::Streamed)
+		{
+			Materialize();
+			data.resize(paddedSize, 0xFF);
+		}
 	}
-	i.close();
 }
 
 auto YaesuFW::Write(const std::string& file) -> void
 {
+	Materialize();
+
 	std::ofstream fout(file, std::ios_base::binary);
 	if (fout.is_open())
 	{
@@ -56,7 +63,7 @@ auto YaesuFW::ToString() const -> std::string
 {
 	std::stringstream out;
 	out << "== Yaesu Firmware == " << std::endl
-		<< "Size:  " << radio_tool::FormatBytes(data.size()) << std::endl;
+		<< "Size:  " << radio_tool::FormatBytes(PayloadSize()) << std::endl;
 	return out.str();
 }
 
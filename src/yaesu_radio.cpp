@@ -18,6 +18,7 @@
  */
 #include <radio_tool/radio/yaesu_radio.hpp>
 #include <radio_tool/fw/yaesu_fw.hpp>
+#include <radio_tool/fw/fw_stream.hpp>
 #include <radio_tool/util/flash.hpp>
 
 #include <math.h>
@@ -42,8 +43,16 @@ auto YaesuRadio::ToString() const -> const std::string
 auto YaesuRadio::WriteFirmware(const std::string& file) -> void
 {
 	auto fw = fw::YaesuFW();
+	fw.SetReadMode(fw::ReadMode::Streamed);
 	fw.Read(file);
 
-	auto to_write = fw.GetData();
-	h8sx.Download(to_write);
+	//program each block as soon as it is read, the checksum is checked at the end
+	auto stream = fw::FirmwareStream(fw);
+	h8sx.BeginDownload();
+	uint32_t bin_sum = 0;
+	while (auto block = stream.Next())
+	{
+		bin_sum += h8sx.Program(block->address, block->data);
+	}
+	h8sx.EndDownload(bin_sum);
 }
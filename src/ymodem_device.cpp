@@ -19,6 +19,7 @@
 #include <radio_tool/device/ymodem_device.hpp>
 
 #include <stdexcept>
+#include <exception>
 #include <fymodem.h>
 #include <stdio.h>
 #include <fcntl.h>
@@ -62,7 +63,7 @@ auto YModemDevice::Erase(const uint32_t&) const -> void
 	throw std::runtime_error("Erase not supported for YModem device");
 }
 
-auto YModemDevice::Write(const std::vector<uint8_t>& data) const -> void
+auto YModemDevice::Write(std::span<const uint8_t> data) const -> void
 {
 	auto fn = std::string(filename);
 	size_t wlen = fymodem_send(fd, (uint8_t*)data.data(), data.size(), fn.data());
@@ -72,6 +73,45 @@ auto YModemDevice::Write(const std::vector<uint8_t>& data) const -> void
 	}
 }
 
+/**
+ * fymodem is C, so errors from the reader are carried across it and rethrown
+ */
+class YModemSource
+{
+public:
+	const std::function<size_t(std::span<uint8_t>)>& read;
+	std::exception_ptr error;
+
+	static auto Read(void* ctx, uint8_t* buf, size_t len) -> size_t
+	{
+		auto src = static_cast<YModemSource*>(ctx);
+		try
+		{
+			return src->read(std::span<uint8_t>(buf, len));
+		}
+		catch (...)
+		{
+			src->error = std::current_exception();
+			return 0;
+		}
+	}
+};
+
+auto YModemDevice::Write(const size_t& size, const std::function<size_t(std::span<uint8_t>)>& read) const -> void
+{
+	auto fn = std::string(filename);
+	auto src = YModemSource{ read, nullptr };
+	size_t wlen = fymodem_send_stream(fd, &YModemSource::Read, &src, size, fn.data());
+	if (src.error)
+	{
+		std::rethrow_exception(src.error);
+	}
+	if (wlen != size)
+	{
+		throw std::runtime_error("Write error");
+	}
+}
+
 auto YModemDevice::Read(const uint16_t& size) const -> std::vector<uint8_t>
 {
 	auto ret = std::vector<uint8_t>();
@@ -0,0 +1,66 @@
+#include <radio_tool/util.hpp>
+
+#include <assert.h>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+using namespace radio_tool;
+
+/**
+ * The original per word loop from AilunceFW
+ */
+static auto AilunceWordsBranchy(std::vector<uint8_t>& data) -> void
+{
+    for (uint32_t i = 0; i < (data.size() / sizeof(uint32_t)); i++)
+    {
+        uint32_t *word = reinterpret_cast<uint32_t *>(data.data()) + i;
+        if (*word == 0x0 || *word == 0xffffffff)
+            *word ^= 0xffffffff;
+        else if (*word & (1 << 28))
+            *word ^= 0x01111111;
+        else
+            *word ^= 0x07777777;
+    }
+}
+
+template <typename F>
+static auto Time(const std::vector<uint8_t>& input, std::vector<uint8_t>& out, F&& fn) -> double
+{
+    constexpr auto Rounds = 20;
+    auto best = std::chrono::nanoseconds::max();
+    for (auto r = 0; r < Rounds; r++)
+    {
+        out = input;
+        auto start = std::chrono::steady_clock::now();
+        fn(out);
+        best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start));
+    }
+    return input.size() / (best.count() / 1e9) / MiB;
+}
+
+int main()
+{
+    // HD1 images are mostly 0xff padding with code mixed in
+    constexpr auto Size = 4 * MiB;
+    auto image = std::vector<uint8_t>(Size, 0xff);
+    std::mt19937 rng(1);
+    for (auto x = 0u; x < Size; x += 4)
+    {
+        if (rng() % 3 == 0)
+        {
+            uint32_t w = rng();
+            memcpy(image.data() + x, &w, sizeof(w));
+        }
+    }
+
+    std::vector<uint8_t> expect, got;
+    std::cout << "Branchy: " << Time(image, expect, AilunceWordsBranchy) << " MiB/s" << std::endl;
+    for (auto level = (int)SimdLevel::Scalar; level <= (int)DetectSimdLevel(); level++)
+    {
+        SetSimdLevel((SimdLevel)level);
+        auto speed = Time(image, got, [](std::vector<uint8_t>& d) { AilunceWords(d); });
+        std::cout << ToString((SimdLevel)level) << ": " << speed << " MiB/s" << std::endl;
+        assert(got == expect);
+    }
+}
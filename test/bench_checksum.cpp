@@ -0,0 +1,108 @@
+#include <radio_tool/util.hpp>
+#include <radio_tool/util/checksum.hpp>
+
+#include <assert.h>
+#include <chrono>
+#include <random>
+
+using namespace radio_tool;
+
+/**
+ * The original iterator loop from CSChecksum
+ */
+static auto CSSumLoop(std::span<const uint8_t> data) -> uint64_t
+{
+    uint16_t sum = 0;
+    auto begin = data.begin();
+    while (begin != data.end())
+    {
+        sum += (*begin);
+        std::advance(begin, 1);
+    }
+    return sum;
+}
+
+/**
+ * The original loop from H8SX::Checksum, before negation
+ */
+static auto H8SXSumLoop(std::span<const uint8_t> data) -> uint64_t
+{
+    uint8_t sum = 0;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        sum += data[i];
+    }
+    return sum;
+}
+
+static volatile uint64_t sink;
+
+/**
+ * Sum the image in blocks, the same as a flash would
+ */
+template <typename F>
+static auto Time(std::vector<uint8_t> input, const size_t& block, uint64_t& out, F&& fn) -> double
+{
+    constexpr auto Rounds = 20;
+    auto best = std::chrono::nanoseconds::max();
+    for (auto r = 0; r < Rounds; r++)
+    {
+        // change the input each round so the sums cant be hoisted out of the loop
+        input[r]++;
+        auto start = std::chrono::steady_clock::now();
+        uint64_t total = 0;
+        for (auto x = 0u; x < input.size(); x += block)
+        {
+            total += fn(std::span<const uint8_t>(input).subspan(x, std::min(block, input.size() - x)));
+        }
+        // volatile store keeps the sum from being moved after the clock is read
+        sink = total;
+        best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start));
+        out = total;
+    }
+    return input.size() / (best.count() / 1e9) / MiB;
+}
+
+int main()
+{
+    constexpr auto Size = 4 * MiB;
+    auto image = std::vector<uint8_t>(Size);
+    std::mt19937 rng(1);
+    std::generate(image.begin(), image.end(), [&rng]() { return (uint8_t)rng(); });
+
+    // SGL sums every 1 KiB, H8SX every 1 KiB program chunk, CS the whole image
+    for (auto block : {0x400ul, Size})
+    {
+        uint64_t cs_expect, h8sx_expect, sgl_expect, got;
+        std::cout << "== Block size " << FormatBytes(block) << " ==" << std::endl;
+        std::cout << "CSChecksum loop: " << Time(image, block, cs_expect, CSSumLoop) << " MiB/s" << std::endl;
+        std::cout << "H8SX::Checksum loop: " << Time(image, block, h8sx_expect, H8SXSumLoop) << " MiB/s" << std::endl;
+        std::cout << "TYTSGLRadio::checksum loop: " << Time(image, block, sgl_expect, [](std::span<const uint8_t> d) {
+            uint32_t counter = 0;
+            for (const auto& b : d)
+            {
+                counter += b;
+            }
+            return (uint64_t)counter;
+        }) << " MiB/s" << std::endl;
+        for (auto level = (int)SimdLevel::Scalar; level <= (int)DetectSimdLevel(); level++)
+        {
+            SetSimdLevel((SimdLevel)level);
+            auto speed = Time(image, block, got, ByteSum);
+            std::cout << ToString((SimdLevel)level) << ": " << speed << " MiB/s" << std::endl;
+            assert(got == sgl_expect);
+        }
+        SetSimdLevel(DetectSimdLevel());
+
+        // each registered algorithm through the streaming interface
+        for (const auto& info : checksum::AllChecksums)
+        {
+            auto sum = info.Create();
+            auto speed = Time(image, block, got, [&sum](std::span<const uint8_t> d) {
+                sum->Init();
+                return (uint64_t)sum->Update(d).Finalize();
+            });
+            std::cout << info.Name << ": " << speed << " MiB/s" << std::endl;
+        }
+    }
+}
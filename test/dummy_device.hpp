@@ -84,7 +84,7 @@ namespace radio_tool::test
 
         constexpr auto FilePos(const uint32_t &addr) const -> const uint32_t
         {
-            return address - map.front().start;
+            return addr - map.Start();
         }
 
         constexpr auto SeekToAddr(const uint32_t &addr) -> void 
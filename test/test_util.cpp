@@ -1,4 +1,12 @@
 #include <radio_tool/util.hpp>
+#include <radio_tool/fw/cipher/cipher.hpp>
+#include <radio_tool/util/checksum.hpp>
+#include <radio_tool/util/flash.hpp>
+#include <radio_tool/dfu/dfu_erase_planner.hpp>
+#include <radio_tool/fw/tyt_fw.hpp>
+#include <radio_tool/fw/fw_stream.hpp>
+#include <radio_tool/radio/tyt_radio.hpp>
+#include <fymodem.h>
 
 #include <assert.h>
 
@@ -7,13 +15,258 @@ int main(int argc, char **argv)
 {
     std::vector<uint8_t> t1 = {'a', 'b', 'c', 'd', 'e'};
     std::vector<uint8_t> t2 = {'a', 'b', 'c', 'd', 'e', 'f'};
-    std::vector<uint8_t> t3 = {'a', 'b', 'c', 'd', 'e', 'f', 'g'};
+    std::vector<uint8_t> t3 = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'};
 
-    auto t1_i = t1.begin();
-    auto t2_i = t2.begin();
-    auto t3_i = t3.begin();
+    assert(Fletcher16(t1) == 0xC8F0);
+    assert(Fletcher16(t2) == 0x2057);
+    assert(Fletcher16(t3) == 0x0627);
+    assert(Fletcher16Sum().Update(std::span(t3).first(3)).Update(std::span(t3).subspan(3)).Finalize() == 0x0627);
 
-    assert(Fletcher16(t1_i, t1.size()) == 0xC8F0);
-    assert(Fletcher16(t2_i, t2.size()) == 0x2057);
-    assert(Fletcher16(t3_i, t3.size()) == 0x0627);
+    // RFC 1071 section 3 example
+    std::vector<uint8_t> rfc1071 = {0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7};
+    assert(InternetChecksum(rfc1071) == 0x220d);
+    assert(InternetSum().Update(std::span(rfc1071).first(3)).Update({}).Update(std::span(rfc1071).subspan(3)).Finalize() == 0x220d);
+    assert(InternetChecksum(std::span(rfc1071).first(7)) == 0x2304);
+
+    // CRC-16/XMODEM check value, and the byte at a time tail against the 8 byte steps
+    const uint8_t crc_check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    assert(fymodem_crc16(0, crc_check, sizeof(crc_check)) == 0x31C3);
+    assert(fymodem_crc16(fymodem_crc16(0, crc_check, 3), crc_check + 3, 6) == 0x31C3);
+    assert(fymodem_crc16(0, crc_check, 0) == 0);
+
+    // every kernel matches the byte at a time XOR, at any offset and length
+    uint8_t key[256], odd_key[100];
+    for (auto x = 0u; x < sizeof(key); x++)
+    {
+        key[x] = x * 7 + 3;
+    }
+    std::copy(key, key + sizeof(odd_key), odd_key);
+    std::vector<uint8_t> plain(3000);
+    for (auto x = 0u; x < plain.size(); x++)
+    {
+        plain[x] = x * 13;
+    }
+    for (auto level = (int)SimdLevel::Scalar; level <= (int)DetectSimdLevel(); level++)
+    {
+        SetSimdLevel((SimdLevel)level);
+        for (auto offset : {0u, 1u, 63u, 255u, 300u, 1000u})
+        {
+            for (auto len : {0u, 1u, 17u, 64u, 255u, 256u, 1000u, 3000u})
+            {
+                auto expect = plain, got = plain, got_odd = plain, expect_odd = plain;
+                for (auto x = 0u; x < len; x++)
+                {
+                    expect[x] ^= key[(offset + x) % sizeof(key)];
+                    expect_odd[x] ^= odd_key[(offset + x) % sizeof(odd_key)];
+                }
+                auto sgl_dec = plain, sgl_enc = plain, expect_dec = plain, expect_enc = plain;
+                for (auto x = 0u; x < len; x++)
+                {
+                    auto& d = expect_dec[x];
+                    d = ~(((d << 3) & 0b11111000) | ((d >> 5) & 0b00000111));
+                    d = d ^ key[(offset + x) % sizeof(key)];
+                    auto& e = expect_enc[x];
+                    e = e ^ key[(offset + x) % sizeof(key)];
+                    e = ~(((e >> 3) & 0b00011111) | ((e << 5) & 0b11100000));
+                }
+                SGLDecrypt(std::span<uint8_t>(sgl_dec.data(), len), key, sizeof(key), offset);
+                SGLEncrypt(std::span<uint8_t>(sgl_enc.data(), len), key, sizeof(key), offset);
+                assert(sgl_dec == expect_dec);
+                assert(sgl_enc == expect_enc);
+
+                XORKeystream(std::span<uint8_t>(got.data(), len), key, sizeof(key), offset);
+                XORKeystream(std::span<uint8_t>(got_odd.data(), len), odd_key, sizeof(odd_key), offset);
+                assert(got == expect);
+                assert(got_odd == expect_odd);
+            }
+        }
+        for (auto len : {0u, 1u, 15u, 16u, 63u, 64u, 65u, 2047u, 3000u})
+        {
+            // odd start so the vector loads are unaligned
+            uint64_t sum = 0;
+            for (auto x = 1u; x <= len; x++)
+            {
+                sum += plain[x];
+            }
+            assert(ByteSum(std::span<const uint8_t>(plain.data() + 1, len)) == sum);
+        }
+        std::vector<uint8_t> all_ff(5000, 0xff);
+        assert(ByteSum(all_ff) == 5000u * 0xff);
+
+        // vector Fletcher matches the byte loop, fed whole or in uneven pieces
+        std::vector<uint8_t> fletcher_ff(20000, 0xff);
+        for (auto data : {std::span<const uint8_t>(plain), std::span<const uint8_t>(fletcher_ff)})
+        {
+            for (auto len : {0ul, 1ul, 31ul, 64ul, 100ul, 4096ul, 4097ul, data.size()})
+            {
+                uint32_t c0 = 0, c1 = 0;
+                for (auto x = 0u; x < len; x++)
+                {
+                    c0 = (c0 + data[x]) % 255;
+                    c1 = (c1 + c0) % 255;
+                }
+                auto head = std::min(len, 77ul);
+                assert(Fletcher16(data.first(len)) == (c1 << 8 | c0));
+                assert(Fletcher16Sum().Update(data.first(head)).Update(data.subspan(head, len - head)).Finalize() == (c1 << 8 | c0));
+
+                uint32_t words = 0;
+                for (auto x = 0u; x < len; x += 2)
+                {
+                    words += (data[x] << 8) | (x + 1 < len ? data[x + 1] : 0);
+                    words = (words & 0xffff) + (words >> 16);
+                }
+                assert(InternetChecksum(data.first(len)) == (uint16_t)~words);
+                assert(InternetSum().Update(data.first(head)).Update(data.subspan(head, len - head)).Finalize() == (uint16_t)~words);
+
+                uint16_t crc = 0;
+                for (auto x = 0u; x < len; x++)
+                {
+                    crc ^= data[x] << 8;
+                    for (auto bit = 0; bit < 8; bit++)
+                    {
+                        crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+                    }
+                }
+                assert(fymodem_crc16(0, data.data(), len) == crc);
+            }
+        }
+    }
+    SetSimdLevel(DetectSimdLevel());
+
+    // chunked parallel cipher matches a single pass
+    std::vector<uint8_t> big(fw::cipher::ParallelChunkSize * 3 + 123);
+    for (auto x = 0u; x < big.size(); x++)
+    {
+        big[x] = x * 31;
+    }
+    auto xor_cipher = fw::cipher::XORCipher(odd_key, sizeof(odd_key), 7);
+    auto serial = big, parallel = big;
+    xor_cipher.Encrypt(serial, 5);
+    fw::cipher::ParallelApply(xor_cipher, fw::CipherDirection::Encrypt, parallel, 5);
+    assert(parallel == serial);
+
+    // summing without transforming matches transform then sum, for the fused XOR and the default copy
+    auto sgl_cipher = fw::cipher::SGLCipher(key, sizeof(key), 3);
+    for (const fw::cipher::Cipher *c : std::initializer_list<const fw::cipher::Cipher *>{&xor_cipher, &sgl_cipher})
+    {
+        auto transformed = big;
+        c->Encrypt(std::span(transformed).subspan(1), 1);
+        auto expect = ByteSum(std::span(transformed).subspan(1));
+        assert(c->Sum(fw::CipherDirection::Encrypt, std::span(big).subspan(1), 1) == expect);
+        assert(fw::cipher::ParallelSum(*c, fw::CipherDirection::Encrypt, std::span(big).subspan(1), 1) == expect);
+    }
+
+    // every registered checksum gives the same answer whole, in pieces, and combined from pieces
+    assert(checksum::GetChecksum("fletcher16")->Update(t3).Finalize() == 0x0627);
+    assert(checksum::GetChecksum("rfc1071")->Update(rfc1071).Finalize() == 0x220d);
+    assert(checksum::GetChecksum("cs")->Update(plain).Finalize() == CSChecksum(plain));
+    assert(checksum::GetChecksum("h8sx")->Update(t1).Update(std::vector<uint8_t>{0xff}).Finalize() == (uint8_t)(0x100 - (('a' + 'b' + 'c' + 'd' + 'e' + 0xff) & 0xff)));
+    for (const auto &info : checksum::AllChecksums)
+    {
+        auto whole = info.Create();
+        whole->Update(plain);
+        for (auto split : {0ul, 1ul, 77ul, 1024ul, plain.size()})
+        {
+            auto head = std::span<const uint8_t>(plain).first(split);
+            auto tail = std::span<const uint8_t>(plain).subspan(split);
+            auto pieces = whole->Create();
+            pieces->Update(head).Update(tail);
+            assert(pieces->Finalize() == whole->Finalize());
+
+            if (whole->Combinable())
+            {
+                auto first = whole->Create(), second = whole->Create();
+                first->Update(head);
+                second->Update(tail);
+                assert(first->Combine(*second).Finalize() == whole->Finalize());
+            }
+        }
+        whole->Init();
+        assert(whole->Finalize() == info.Create()->Finalize());
+    }
+
+    // run length flash maps find the same sectors as a list of every sector
+    const std::vector<std::pair<uint32_t, uint32_t>> stm32_sectors = {
+        {0x08000000, 0x4000}, {0x08004000, 0x4000}, {0x08008000, 0x4000}, {0x0800c000, 0x4000},
+        {0x08010000, 0x10000}, {0x08020000, 0x20000}, {0x08040000, 0x20000}, {0x08060000, 0x20000},
+        {0x08080000, 0x20000}, {0x080a0000, 0x20000}, {0x080c0000, 0x20000}, {0x080e0000, 0x20000}};
+    assert(!flash::STM32F40X.GetSector(0x07ffffff) && !flash::STM32F40X.GetSector(0x08100000));
+    for (auto x = 0u; x < stm32_sectors.size(); x++)
+    {
+        const auto &[start, size] = stm32_sectors[x];
+        for (auto addr : {start, start + 1, start + size - 1})
+        {
+            auto sec = flash::FlashUtil::GetSector(flash::STM32F40X, addr);
+            assert(sec && sec->index == x && sec->start == start && sec->size == size);
+        }
+        assert(flash::STM32F40X.Sector(x)->start == start);
+    }
+
+    constexpr auto spi_4k = flash::FlashUtil::MakeSimpleLayout(0, 0x1000, 4096);
+    static_assert(spi_4k.GetSector(0xffffff)->index == 4095);
+    auto visited_bytes = 0u, visited_sectors = 0u;
+    flash::FlashUtil::AlignedContiguousMemoryOp(flash::STM32F40X, 0x08003000, 0x08030000, [&](const uint32_t &addr, const uint32_t &n, const flash::FlashSector &sec) {
+        assert(sec.InSector(addr) && addr + n <= sec.End());
+        assert(addr == 0x08003000 + visited_bytes);
+        visited_bytes += n;
+        visited_sectors++;
+    });
+    assert(visited_bytes == 0x2d000 && visited_sectors == 6);
+
+    // a full image mass erases, anything else erases each touched sector once, and protected sectors are never erased
+    auto unprotected = dfu::DFUErasePlanner(flash::STM32F40X, {}, true);
+    assert(unprotected.Plan({{0x08000000, 0x100000}}).strategy == dfu::EraseStrategy::Mass);
+    assert(dfu::DFUErasePlanner(flash::STM32F40X, {}, false).Plan({{0x08000000, 0x100000}}).strategy == dfu::EraseStrategy::Sectors);
+    assert(unprotected.Plan({}).strategy == dfu::EraseStrategy::None);
+    auto partial = unprotected.Plan({{0x0800c000, 0x5000}, {0x08010800, 0x100}, {0x08200000, 0x100}});
+    assert(partial.strategy == dfu::EraseStrategy::Sectors && partial.sectors.size() == 2);
+    assert(partial.sectors[0].index == 3 && partial.sectors[1].index == 4);
+
+    auto tyt = dfu::DFUErasePlanner(flash::STM32F40X, {0, 1, 2}, true);
+    auto tyt_full = tyt.Plan({{0x0800c000, 0xf4000}});
+    assert(tyt_full.strategy == dfu::EraseStrategy::Sectors && tyt_full.sectors.size() == 9);
+    auto overlaps = false;
+    try
+    {
+        tyt.Plan({{0x08004000, 0x100}});
+    }
+    catch (const std::runtime_error &)
+    {
+        overlaps = true;
+    }
+    assert(overlaps);
+
+    // two segments in one sector are planned once, streamed next to each other and compared as one sector image
+    auto shared = std::vector<std::pair<uint32_t, uint32_t>>{{0x08010000, 0x400}, {0x08018000, 0x400}};
+    auto shared_plan = tyt.Plan(shared);
+    assert(shared_plan.sectors.size() == 1 && shared_plan.sectors[0].index == 4);
+
+    auto two_segments = fw::TYTFW();
+    two_segments.AppendSegment(0x08010000, std::vector<uint8_t>(0x400, 0x11));
+    two_segments.AppendSegment(0x08018000, std::vector<uint8_t>(0x400, 0x22));
+    auto sector_blocks = std::vector<fw::FirmwareBlock>();
+    auto sector_stream = fw::FirmwareStream(two_segments, flash::STM32F40X);
+    while (auto block = sector_stream.Next())
+    {
+        sector_blocks.push_back(std::move(block.value()));
+    }
+    assert(sector_blocks.size() == 2 && sector_blocks[0].sector->index == 4 && sector_blocks[1].sector->index == 4);
+
+    const auto &sector4 = sector_blocks[0].sector.value();
+    auto image = radio::TYTRadio::ExpectedSector(sector4, sector_blocks);
+    assert(image.size() == sector4.size);
+    assert(image[0] == 0x11 && image[0x3ff] == 0x11 && image[0x400] == 0xff && image[0x7fff] == 0xff);
+    assert(image[0x8000] == 0x22 && image[0x83ff] == 0x22 && image[0x8400] == 0xff && image.back() == 0xff);
+
+    // a block which doesnt fit the sector is rejected
+    auto outside = false;
+    try
+    {
+        radio::TYTRadio::ExpectedSector(*flash::STM32F40X.Sector(3), sector_blocks);
+    }
+    catch (const std::invalid_argument &)
+    {
+        outside = true;
+    }
+    assert(outside);
 }
\ No newline at end of file
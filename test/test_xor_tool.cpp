@@ -32,7 +32,7 @@ int main(int argc, char **argv)
         //Only test segments which are mapped to mcu flash section
         if (FlashUtil::GetSector(STM32F40X, region.address))
         {
-            if (radio_tool::fw::XORTool::Verify(region.address, region.data, key))
+            if (radio_tool::fw::XORTool::Verify(region.address, std::vector<uint8_t>(region.data.begin(), region.data.end()), key))
             {
                 std::cout
                     << "Region @ 0x" << std::setfill('0') << std::setw(8) << std::hex << region.address